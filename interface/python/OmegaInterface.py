@@ -61,16 +61,30 @@ def str2hyperrects(strHRs):
 
     return hyperrects
 
-# a class to represent a symbolic model
+# a class to represent a symbolic model: the text file of the symbolic model is loaded
+# while its binary file (see system.symmodel_file_format) is mapped to memory
 class SymbolicModel:
+    BINARY_MAGIC = b'OMEGASYM'
+    BINARY_VERSION = 2
+    # the tokens of the (x,u) without posts in text files (see write_symmodel)
+    NO_POSTS_TOKENS = ['unreachable', 'out_of_domain']
+
     def __init__(self, filename, x_symbols, u_symbols):
         self.filename = filename
         self.x_symbols = x_symbols 
         self.u_symbols = u_symbols
         self.xu_symbols = x_symbols*u_symbols
-        self.xu_HR = [None] * self.xu_symbols
-        
-        self.load_model()
+        self.xu_HR = None
+        self.xu_posts = None
+
+        with open(self.filename, 'rb') as model_file:
+            is_binary = (model_file.read(len(self.BINARY_MAGIC)) == self.BINARY_MAGIC)
+
+        if is_binary:
+            self.map_model()
+        else:
+            self.xu_HR = [None] * self.xu_symbols
+            self.load_model()
 
     def load_model(self):
         model_file = open(self.filename, 'r')
@@ -78,19 +92,81 @@ class SymbolicModel:
         for line in model_lines:
             head_splitted = line.split('=>')
             xu_info = head_splitted[0].replace(" ","").replace("[","").replace("]","")
-            hr_info = head_splitted[1].replace(" ","")
+            hr_info = head_splitted[1].replace(" ","").strip()
             
             x = int(xu_info.split(',')[0].replace("x_",""))
             u = int(xu_info.split(',')[1].replace("u_",""))
-            hr = str2hyperrects(hr_info)[0]
+            if hr_info in self.NO_POSTS_TOKENS:
+                hr = None
+            else:
+                hr = str2hyperrects(hr_info)[0]
 
             if(x >= self.x_symbols or u >= self.u_symbols):
                 print("SymModel.load_model:: for x=" + str(x) + "/" + str(self.x_symbols) + ", u=" + str(u) + "/"+str(self.u_symbols)+": Invalid index for line: " + line.replace("\n",""))
 
             self.xu_HR[u + x*self.u_symbols] = hr
 
+    def map_model(self):
+        # the header: the magic followed by 64-bit fields (see func_construct_symmodel.cpp)
+        header = [int(v) for v in numpy.fromfile(self.filename, dtype=numpy.uint64, count=12)[1:]]
+        (version, concrete_size, compact_posts, x_dim, u_dim, x_symbols, u_symbols, 
+            size_struct_xu_posts, grid_offset, reach_offset, posts_offset) = header
+        if version != self.BINARY_VERSION:
+            raise ValueError("SymModel.map_model:: unsupported version (" + str(version) + ") of the file: " + self.filename)
+        if x_symbols != self.x_symbols or u_symbols != self.u_symbols:
+            raise ValueError("SymModel.map_model:: the file " + self.filename + " has " + str(x_symbols) + " state symbols and " + 
+                str(u_symbols) + " control symbols instead of " + str(self.x_symbols) + " and " + str(self.u_symbols) + ".")
+
+        # the grid: lb/ub/quantizers of the states and the controls, then their widths
+        concrete_t = numpy.float32 if concrete_size == 4 else numpy.float64
+        grid = numpy.memmap(self.filename, dtype=concrete_t, mode='r', offset=grid_offset, shape=(3*(x_dim + u_dim),))
+        self.x_dim = x_dim
+        self.x_lb = grid[0:x_dim]
+        self.x_ub = grid[x_dim:2*x_dim]
+        self.x_eta = grid[2*x_dim:3*x_dim]
+        self.x_widths = numpy.memmap(self.filename, dtype=numpy.uint64, mode='r', 
+            offset=grid_offset + 3*(x_dim + u_dim)*concrete_size, shape=(x_dim,))
+
+        # the reach set and the posts of all (x,u)
+        self.x_reachable = numpy.memmap(self.filename, dtype=numpy.uint8, mode='r', offset=reach_offset, shape=(x_symbols,))
+        self.compact_posts = (compact_posts != 0)
+        if self.compact_posts:
+            # the extents are as wide as the widest dimension of the states needs (1, 2 or 4 bytes)
+            extent_t = {1: numpy.uint8, 2: numpy.uint16, 4: numpy.uint32}.get((size_struct_xu_posts - 5)//x_dim, numpy.uint8)
+            xu_posts_t = numpy.dtype([('lb_flat', numpy.uint32), ('extents', extent_t, (x_dim,)), ('flags', numpy.uint8)])
+        else:
+            xu_posts_t = numpy.dtype([('lb', concrete_t, (x_dim,)), ('ub', concrete_t, (x_dim,))])
+        if xu_posts_t.itemsize != size_struct_xu_posts:
+            raise ValueError("SymModel.map_model:: invalid size of the posts in the file: " + self.filename)
+        self.xu_posts = numpy.memmap(self.filename, dtype=xu_posts_t, mode='r', offset=posts_offset, shape=(self.xu_symbols,))
+
+    # returns the posts of (x,u) as a HyperRect, or None for the (x,u) that have no posts
+    # (out of the reach set, or out of the state space with compact posts)
     def get_HR(self, x, u):
-        return self.xu_HR[u + x*self.u_symbols]
+        if self.xu_posts is None:
+            return self.xu_HR[u + x*self.u_symbols]
+
+        if self.x_reachable[x] == 0:
+            return None
+
+        posts = self.xu_posts[u + x*self.u_symbols]
+        if not self.compact_posts:
+            return HyperRect([float(v) for v in posts['lb']], [float(v) for v in posts['ub']])
+
+        # the compact posts: the union of the cells of the post symbols
+        if posts['flags'] != 0:
+            return None
+        lb_flat = int(posts['lb_flat'])
+        HR_lb = []
+        HR_ub = []
+        for i in range(self.x_dim):
+            width = int(self.x_widths[i])
+            eta = float(self.x_eta[i])
+            sym_lb = lb_flat % width
+            lb_flat = lb_flat // width
+            HR_lb.append(float(self.x_lb[i]) + sym_lb*eta - eta/2.0)
+            HR_ub.append(float(self.x_lb[i]) + (sym_lb + int(posts['extents'][i]))*eta + eta/2.0)
+        return HyperRect(HR_lb, HR_ub)
 
 # a class to represent a machine transition
 class MachineTransition:
@@ -7,6 +7,8 @@
 
 #include "omega.h"
 
+#include <cstring>
+
 // uncomment this to get the parallel implementation (Experimental!)
 //#define PARALLEL_IMPLEMENTATION
 
@@ -17,99 +19,110 @@ std::vector<symbolic_t> dpa_data;
 namespace pFacesOmegaKernels {
 
 #ifndef PARALLEL_IMPLEMENTATION
-	/* a function to retrive the posts (must conform with omegaControlProblem.h) */
-	std::vector<symbolic_t> get_sym_posts(symbolic_t x_flat, symbolic_t u_flat){
+	/* a function to retrive the posts as a box of symbols (must conform with omegaControlProblem.h) */
+	void get_sym_posts(symbolic_t x_flat, symbolic_t u_flat, PostBox& posts_box){
 		
-		static size_t buff0Idx = pKernel->getBufferIndex(construct_symmodel_func_name, construct_symmodel_arg_names[0], pKernel->memReport);
-		static concrete_t* pData	= (concrete_t*)pKernel->dataPool[buff0Idx].first;
+		static const concrete_t* pData	= (const concrete_t*)pKernel->xu_posts_data;
 		static const std::vector<concrete_t>& ssLb		= pKernel->x_lb;
 		static const std::vector<concrete_t>& ssUb		= pKernel->x_ub;
 		static const std::vector<concrete_t>& ssEta		= pKernel->x_qs;
 		static const std::vector<symbolic_t>& ssWidths	= pKernel->x_widths;
 		static size_t ssDim = pKernel->x_dim;
 		static size_t num_cons_in_xu_struct = pKernel->size_struct_xu_posts / sizeof(concrete_t);
-		
-		static bool calledBefore = false;
-		static std::vector<symbolic_t> first_cell_in_dim;
-		static std::vector<symbolic_t> dim_posts_count;
-		static std::vector<symbolic_t> postcell;
-		static std::vector<concrete_t> rectLb;
-		static std::vector<concrete_t> rectUb;
-
-		// prepare some required static data
-		if (!calledBefore) {
-
-			first_cell_in_dim.resize(ssDim);
-			dim_posts_count.resize(ssDim);
-			postcell.resize(ssDim);
-			rectLb.resize(ssDim);
-			rectUb.resize(ssDim);
-
-			for (size_t i = 0; i<ssDim; i++) {
-				if (i == 0)
-					first_cell_in_dim[i] = 1;
-				else {
-					first_cell_in_dim[i] = first_cell_in_dim[i - 1] * ssWidths[i - 1];
-				}
-			}
-			calledBefore = true;
+
+		// the posts of the states out of the reach set are not constructed (see reach_symmodel)
+		if(pKernel->reach_states[x_flat] == REACH_UNREACHED){
+			throw std::runtime_error(
+				std::string("get_sym_posts: the state x=") + std::to_string(x_flat) + 
+				std::string(" is not in the reach set of the symbolic model (system.reachability_waves).")
+			);
 		}
 
-		// get the lb/ub of OARS rectangle using x_flat and u_flat
-		bool out_of_domain = false;
-		size_t xu_flat = x_flat*pKernel->u_symbols + u_flat;
-		for (size_t i=0; i<ssDim; i++){
-			rectLb[i] = pData[xu_flat*num_cons_in_xu_struct + i];
-			rectUb[i] = pData[xu_flat*num_cons_in_xu_struct + ssDim + i];
+		// the flat distance between neighboring symbols in each dimension
+		posts_box.overflow = false;
+		posts_box.dim = ssDim;
+		for (size_t i = 0; i<ssDim; i++)
+			posts_box.strides[i] = (i == 0 ? 1 : posts_box.strides[i - 1]*ssWidths[i - 1]);
 
-			if(rectLb[i] < ssLb[i] || rectUb[i] > ssUb[i]){
-				out_of_domain = true;
-				break;
+		// the flat index of the lower-left post and the number of posts per dimension
+		size_t xu_flat = x_flat*pKernel->u_symbols + u_flat;
+		posts_box.lb_flat = 0;
+		if(pKernel->compact_posts){
+
+			// the OARS rectangle is already symbolized by the device
+			const char* pPosts = (const char*)pData + xu_flat*pKernel->size_struct_xu_posts;
+			cl_uint lb_flat;
+			std::memcpy(&lb_flat, pPosts, sizeof(cl_uint));
+			const cl_uchar flags = pPosts[sizeof(cl_uint) + ssDim*pKernel->compact_extent_size];
+
+			if(flags & COMPACT_POSTS_OUT_OF_DOMAIN){
+				posts_box.overflow = true;
+				return;
 			}
+
+			posts_box.lb_flat = lb_flat;
+			for (size_t j = 0; j<ssDim; j++)
+				posts_box.counts[j] = get_compact_posts_extent(pPosts, j, pKernel->compact_extent_size) + 1;
 		}
-		if(out_of_domain){
-			return {std::numeric_limits<symbolic_t>::max()};
-		}
+		else {
+
+			// get the lb/ub of OARS rectangle using x_flat and u_flat and symbolize it with the
+			// same expression and precision (concrete_t) as quantize_posts in omega_symmodel.cl
+			const concrete_t* rectLb = pData + xu_flat*num_cons_in_xu_struct;
+			const concrete_t* rectUb = rectLb + ssDim;
+			for (size_t i=0; i<ssDim; i++){
+				if(rectLb[i] < ssLb[i] || rectUb[i] > ssUb[i]){
+					posts_box.overflow = true;
+					return;
+				}
 
-		// Now, we have to symbolize the OARS
-		std::vector<symbolic_t> sym_lb = OmegaUtils::Conc2Symbolic(rectLb, ssEta, ssLb);
-		std::vector<symbolic_t> sym_ub = OmegaUtils::Conc2Symbolic(rectUb, ssEta, ssLb);
-		symbolic_t n_rect_symbols = 1;
-		for (unsigned int j = 0; j<ssDim; j++) {
-			/* compute width per dimension */
-			dim_posts_count[j] = sym_ub[j] - sym_lb[j] + 1;
-
-			/* update number of posts */
-			n_rect_symbols *= dim_posts_count[j];
-
-			/* initialize postcell */
-			postcell[j] = 0;
-		}		
-
-		// collect posts
-		std::vector<symbolic_t> ret(n_rect_symbols);
-		for (size_t p = 0; p < n_rect_symbols; p++)
-		{
-			/* compute the symbolic index of the post from its flat index */
-			size_t post_x_flat = 0;
-			for (size_t i = 0; i<ssDim; i++)
-				post_x_flat += (sym_lb[i] + postcell[i])* first_cell_in_dim[i];
-
-			ret[p] = post_x_flat;
-
-			// prepare the counters for other posts
-			postcell[0]++;
-			for (size_t i = 0; i<ssDim - 1; i++) {
-				if (postcell[i] == dim_posts_count[i]) {
-					postcell[i] = 0;
-					postcell[i + 1]++;
+				const concrete_t half_eta = ssEta[i]/(concrete_t)2;
+				symbolic_t sym_lb = (symbolic_t)((concrete_t)(rectLb[i] - ssLb[i] + half_eta)/ssEta[i]);
+				symbolic_t sym_ub = (symbolic_t)((concrete_t)(rectUb[i] - ssLb[i] + half_eta)/ssEta[i]);
+				if(sym_ub >= ssWidths[i]){
+					posts_box.overflow = true;
+					return;
 				}
+				posts_box.counts[i] = sym_ub - sym_lb + 1;
+				posts_box.lb_flat += sym_lb*posts_box.strides[i];
+			}
+		}
+	}
+
+#ifdef TEST_FUNCTION
+	/* a host-side function to test that the posts of the reached states are reached (see reach_symmodel) */
+	size_t test_sym_posts(void* pPackedKernel, void* pPackedParallelProgram){
+		(void)pPackedParallelProgram;
+		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
+
+		PostBox posts_box;
+		for (symbolic_t x_flat = 0; x_flat < pKernel->x_symbols; x_flat++){
+			if(pKernel->reach_states[x_flat] == REACH_UNREACHED)
+				continue;
+
+			for (symbolic_t u_flat = 0; u_flat < pKernel->u_symbols; u_flat++){
+				get_sym_posts(x_flat, u_flat, posts_box);
+				if(posts_box.overflow)
+					continue;
+
+				posts_box.for_each([&](const symbolic_t post_flat){
+					if(post_flat >= pKernel->x_symbols || pKernel->reach_states[post_flat] == REACH_UNREACHED){
+						throw std::runtime_error(
+							std::string("test_sym_posts: the post x'=") + std::to_string(post_flat) +
+							std::string(" of (x=") + std::to_string(x_flat) + std::string(", u=") + std::to_string(u_flat) +
+							std::string(") is not in the reach set of the symbolic model.")
+						);
+					}
+				});
 			}
-		}		
+		}
 
-		
-		return ret;
+		pfacesTerminal::showInfoMessage(
+			std::string("Symbolic model posts test completed successfully!")
+		);
+		return 0;
 	}
+#endif
 
 	/* map L_x returns the APs mask for a state x (must conform with omegaControlProblem.h) */
 	symbolic_t L_x(symbolic_t x){
@@ -142,11 +155,37 @@ namespace pFacesOmegaKernels {
     /* to init the function */
     void pFacesOmega::init_construct_pgame(){
 
-        // create the specs wrapper
-        std::string ltl_formula = m_spCfg->readConfigValueString("specifications.ltl_formula");
-		std::string dpa_file = m_spCfg->readConfigValueString("specifications.dpa_file");
-		bool write_dpa = m_spCfg->readConfigValueBool("specifications.write_dpa");
-		std::string save_dpa_file = 
+        // read the specs config (the DPA is constructed in construct_dpa after the APs are discovered)
+        ltl_formula = m_spCfg->readConfigValueString("specifications.ltl_formula");
+		dpa_file = m_spCfg->readConfigValueString("specifications.dpa_file");
+		write_dpa = m_spCfg->readConfigValueBool("specifications.write_dpa");
+		realizable_letters_only = m_spCfg->readConfigValueBool("specifications.realizable_letters_only");
+		std::string str_dpa_storage = m_spCfg->readConfigValueString("specifications.dpa_storage");
+		if(str_dpa_storage == std::string("table"))
+			dpa_storage = DpaStorage::TABLE;
+		else if(str_dpa_storage == std::string("decision_tree"))
+			dpa_storage = DpaStorage::DECISION_TREE;
+		else if(str_dpa_storage == std::string("lazy"))
+			dpa_storage = DpaStorage::LAZY;
+		else
+			throw std::runtime_error("pFacesOmega::init_construct_pgame: invalid DPA storage (specifications.dpa_storage) in the config file.");
+		std::string str_dpa_file_format = m_spCfg->readConfigValueString("specifications.dpa_file_format");
+		if(str_dpa_file_format == std::string("text"))
+			dpa_file_format = DpaFileFormat::TEXT;
+		else if(str_dpa_file_format == std::string("binary"))
+			dpa_file_format = DpaFileFormat::BINARY;
+		else
+			throw std::runtime_error("pFacesOmega::init_construct_pgame: invalid DPA file format (specifications.dpa_file_format) in the config file.");
+		dpa_construction_threads = m_spCfg->readConfigValueInt("specifications.dpa_construction_threads");
+		minimize_dpa = m_spCfg->readConfigValueBool("specifications.minimize_dpa");
+		normalize_dpa_colors = m_spCfg->readConfigValueBool("specifications.normalize_dpa_colors");
+		dpa_cache_dir = m_spCfg->readConfigValueString("specifications.dpa_cache_dir");
+		if(!dpa_cache_dir.empty()){
+			dpa_cache_dir = pfacesFileIO::getFileDirectoryPath(m_spCfg->getConfigFilePath()) + dpa_cache_dir;
+			if(dpa_cache_dir.back() != '/' && dpa_cache_dir.back() != '\\')
+				dpa_cache_dir += std::string(PFACES_PATH_SPLITTER);
+		}
+		save_dpa_file = 
 			pfacesFileIO::getFileDirectoryPath(m_spCfg->getConfigFilePath()) + 
 			m_spCfg->readConfigValueString("project_name") + 
 			std::string(".dpa");		
@@ -155,36 +194,27 @@ namespace pFacesOmegaKernels {
 			throw std::runtime_error("pFacesOmega::init_construct_pgame: you have to provide either dpa_file or ltl_formula as specification but not both at the same time.");
 
 #ifndef PARALLEL_IMPLEMENTATION
-		pfacesTimer tmr_dpa;
-		tmr_dpa.tic();
-
-		if(!ltl_formula.empty())
-        	pSymSpec = std::make_shared<SymSpec<L_x_func_t, L_u_func_t>>(x_aps, u_aps, ltl_formula, L_x, L_u);
-		else if(!dpa_file.empty())
-			pSymSpec = std::make_shared<SymSpec<L_x_func_t, L_u_func_t>>(dpa_file, L_x, L_u);			
-		else
+		if(ltl_formula.empty() && dpa_file.empty())
 			throw std::runtime_error("pFacesOmega::init_construct_pgame: no valid specification is provided in the config file.");
 
-		auto time_dpa = tmr_dpa.toc();
-
-		if(write_dpa){
-			pSymSpec->dpa.writeToFile(save_dpa_file);
-		}
+		// create the sym-model wrapper (the posts are boxes in the stack, see PostBox)
+		if(x_dim > PostBox::MAX_DIM)
+			throw std::runtime_error("pFacesOmega::init_construct_pgame: the states have more than " + std::to_string(PostBox::MAX_DIM) + " dimensions.");
+        pSymModel = std::make_shared<SymModel<post_func_t>>(x_symbols, u_symbols, initial_states, get_sym_posts);
 
+		// the parity game config
+		parallel_construction = m_spCfg->readConfigValueBool("game.parallel_construction");
+		construction_threads = m_spCfg->readConfigValueInt("game.construction_threads");
 
-        pfacesTerminal::showInfoMessage(
-            std::string("The DPA is constructed in ") +
-			std::to_string(time_dpa.count()) + 
-			std::string(" seconds and it has ") + 
-			std::to_string(pSymSpec->count_DPA_states()) +
-            std::string(" states. ")
-        );
+		// the posts of the (x,u) pairs reached by the game are computed on demand and cached
+		if(m_spCfg->readConfigValueBool("game.cache_posts"))
+			pSymModel->enable_posts_cache(construction_threads);
 
-		// create the sym-model wrapper
-        pSymModel = std::make_shared<SymModel<post_func_t>>(x_symbols, u_symbols, initial_states, get_sym_posts);
+		// or the posts of all the (x,u) pairs are tabulated before the game is constructed
+		posts_table = m_spCfg->readConfigValueBool("game.posts_table");
 
-		// create the parity game
-		pParityGame = std::make_shared<PGame<post_func_t, L_x_func_t, L_u_func_t>>(*pSymSpec, *pSymModel);
+		// the predecessors of the states (for backward reasoning) are tabulated as well if requested
+		pre_table = m_spCfg->readConfigValueBool("game.pre_table");
 #endif			
 
 
@@ -196,8 +226,11 @@ namespace pFacesOmegaKernels {
 		else
 			pDpa = std::make_shared<TotalDPA>(dpa_file);
 
+		if(minimize_dpa)
+			pDpa->minimize(normalize_dpa_colors, dpa_construction_threads);
+
 		if(write_dpa){
-			pDpa->writeToFile(save_dpa_file);
+			pDpa->writeToFile(save_dpa_file, dpa_file_format);
 		}
 
 		// dump the dpa to raw memory (here as a vector of symbolic_t)
@@ -222,6 +255,204 @@ namespace pFacesOmegaKernels {
     }
 
 #ifndef PARALLEL_IMPLEMENTATION
+	size_t construct_dpa(void* pPackedKernel, void* pPackedParallelProgram){
+
+		(void)pPackedParallelProgram;
+		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
+
+		// the DPA alphabet: only the letters that can be seen in the game (if requested)
+		DpaAlphabet alphabet;
+		if(pKernel->realizable_letters_only){
+			alphabet.in_letters.push_back(0);
+			if(!pKernel->dont_discover_x_aps && !pKernel->x_aps.empty())
+				for(symbolic_t x = 0; x < pKernel->x_symbols; x++)
+					alphabet.in_letters.push_back(L_x(x));
+
+			if(!pKernel->dont_discover_u_aps && !pKernel->u_aps.empty())
+				for(symbolic_t u = 0; u < pKernel->u_symbols; u++)
+					alphabet.out_letters.push_back(L_u(u));
+			else
+				alphabet.out_letters.push_back(0);
+		}
+
+		// a DPA constructed before from the same formula, APs and alphabet is loaded from the cache (if any)
+		std::string cache_file;
+		if(!pKernel->ltl_formula.empty() && !pKernel->dpa_cache_dir.empty() && pKernel->dpa_storage != DpaStorage::LAZY)
+			cache_file = pKernel->dpa_cache_dir + TotalDPA::getCacheKey(pKernel->x_aps, pKernel->u_aps, pKernel->ltl_formula, false, alphabet) + std::string(".dpa");
+		const bool cache_hit = !cache_file.empty() && pfacesFileIO::isFileExist(cache_file);
+
+		pfacesTimer tmr_dpa;
+		tmr_dpa.tic();
+
+		if(cache_hit)
+			pKernel->pSymSpec = std::make_shared<SymSpec<L_x_func_t, L_u_func_t>>(cache_file, L_x, L_u, alphabet, pKernel->dpa_storage);
+		else if(!pKernel->ltl_formula.empty())
+        	pKernel->pSymSpec = std::make_shared<SymSpec<L_x_func_t, L_u_func_t>>(pKernel->x_aps, pKernel->u_aps, pKernel->ltl_formula, L_x, L_u, alphabet, pKernel->dpa_storage, pKernel->dpa_construction_threads);
+		else
+			pKernel->pSymSpec = std::make_shared<SymSpec<L_x_func_t, L_u_func_t>>(pKernel->dpa_file, L_x, L_u, alphabet, pKernel->dpa_storage);
+
+		auto time_dpa = tmr_dpa.toc();
+
+		// merge the equivalent DPA states (before the DPA is cached/written)
+		if(pKernel->minimize_dpa && pKernel->pSymSpec->dpa.getStorage() != DpaStorage::LAZY){
+			pfacesTimer tmr_minimize;
+			tmr_minimize.tic();
+			const size_t n_states_before = pKernel->pSymSpec->count_DPA_states();
+			pKernel->pSymSpec->dpa.minimize(pKernel->normalize_dpa_colors, pKernel->dpa_construction_threads);
+			auto time_minimize = tmr_minimize.toc();
+
+			pfacesTerminal::showInfoMessage(
+				std::string("construct_dpa: The DPA is minimized from ") +
+				std::to_string(n_states_before) +
+				std::string(" to ") + 
+				std::to_string(pKernel->pSymSpec->count_DPA_states()) +
+				std::string(" states in ") + 
+				std::to_string(time_minimize.count()) + 
+				std::string(" seconds. ")
+			);
+		}
+
+		// add a newly constructed DPA to the cache. the cached files are binary to be mapped when they
+		// are loaded. a DPA that cannot be cached is only constructed again by the next run
+		if(!cache_file.empty() && !cache_hit){
+			const bool cached = OmegaUtils::WriteCacheFile(cache_file, [&](const std::string& tmp_file){
+				pKernel->pSymSpec->dpa.writeToFile(tmp_file, DpaFileFormat::BINARY);
+			});
+			if(!cached)
+				pfacesTerminal::showWarnMessage(std::string("construct_dpa: could not add the DPA to the cache directory: ") + pKernel->dpa_cache_dir);
+		}
+
+		if(pKernel->write_dpa){
+			pKernel->pSymSpec->dpa.writeToFile(pKernel->save_dpa_file, pKernel->dpa_file_format);
+		}
+
+		if(pKernel->pSymSpec->dpa.getStorage() == DpaStorage::LAZY)
+			pfacesTerminal::showInfoMessage(
+				std::string("construct_dpa: The DPA tree structure is constructed in ") +
+				std::to_string(time_dpa.count()) + 
+				std::string(" seconds and its states will be explored while constructing the parity game. ")
+			);
+		else
+			pfacesTerminal::showInfoMessage(
+				std::string(cache_hit ? "construct_dpa: The DPA is loaded from the cache in " : "construct_dpa: The DPA is constructed in ") +
+				std::to_string(time_dpa.count()) + 
+				std::string(" seconds and it has ") + 
+				std::to_string(pKernel->pSymSpec->count_DPA_states()) +
+				std::string(" states and ") + 
+				std::to_string(pKernel->pSymSpec->dpa.getLettersCount()) +
+				std::string(" letters. ")
+			);
+
+		// create the parity game
+		pKernel->pParityGame = std::make_shared<PGame<post_func_t, L_x_func_t, L_u_func_t>>(
+			*pKernel->pSymSpec, *pKernel->pSymModel, pKernel->parallel_construction, pKernel->construction_threads);
+
+		return 0;
+	}
+
+	size_t build_posts_table(void* pPackedKernel, void* pPackedParallelProgram){
+
+		(void)pPackedParallelProgram;
+		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
+
+		// the states out of the reach set of the symbolic model have no posts
+		pfacesTimer tmr_table;
+		tmr_table.tic();
+		pKernel->pSymModel->build_posts_table(pKernel->construction_threads, pKernel->reach_states);
+		auto time_table = tmr_table.toc();
+
+		pfacesTerminal::showInfoMessage(
+			std::string("build_posts_table: The table of posts is built in ") +
+			std::to_string(time_table.count()) +
+			std::string(" seconds and it has ") +
+			std::to_string(pKernel->pSymModel->get_n_table_posts()) +
+			std::string(" posts of the ") +
+			std::to_string(pKernel->xu_symbols) + std::string(" (x,u) pairs.")
+		);
+
+		return 0;
+	}
+
+	size_t build_pre_table(void* pPackedKernel, void* pPackedParallelProgram){
+
+		(void)pPackedParallelProgram;
+		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
+
+		// the table is cached next to the symbolic model it belongs to (same key)
+		std::string cache_file;
+		if(!pKernel->symmodel_cache_file.empty())
+			cache_file = pKernel->symmodel_cache_file.substr(0, pKernel->symmodel_cache_file.rfind('.')) + std::string(".precache");
+		const bool cache_hit = !cache_file.empty() && pfacesFileIO::isFileExist(cache_file);
+
+		pfacesTimer tmr_table;
+		tmr_table.tic();
+		if(cache_hit)
+			pKernel->pSymModel->load_pre_table_file(cache_file);
+		else
+			pKernel->pSymModel->build_pre_table(pKernel->construction_threads, pKernel->reach_states);
+		auto time_table = tmr_table.toc();
+
+		// add it to the cache
+		if(!cache_file.empty() && !cache_hit){
+			const bool cached = OmegaUtils::WriteCacheFile(cache_file, [&](const std::string& tmp_file){
+				pKernel->pSymModel->write_pre_table_file(tmp_file);
+			});
+			if(!cached)
+				pfacesTerminal::showWarnMessage(std::string("build_pre_table: could not add the table of predecessors to the cache: ") + cache_file);
+		}
+
+		pfacesTerminal::showInfoMessage(
+			std::string(cache_hit ? "build_pre_table: The table of predecessors is loaded from the cache in " : "build_pre_table: The table of predecessors is built in ") +
+			std::to_string(time_table.count()) +
+			std::string(" seconds and it has ") +
+			std::to_string(pKernel->pSymModel->get_n_table_pres()) +
+			std::string(" (x,u) pairs in the rows of the ") +
+			std::to_string(pKernel->x_symbols) + std::string(" states.")
+		);
+
+		return 0;
+	}
+
+#ifdef TEST_FUNCTION
+	/* test that two constructions of the arena (serial and parallel) give the same nodes and edges */
+	static void test_same_arenas(PGame<post_func_t, L_x_func_t, L_u_func_t>& arena, PGame<post_func_t, L_x_func_t, L_u_func_t>& other_arena){
+		auto fail = [](const std::string& what){
+			throw std::runtime_error(std::string("test_construct_pgame: the serial and the parallel constructions give different ") + what + std::string("."));
+		};
+
+		if(arena.get_n_env_nodes() != other_arena.get_n_env_nodes() || arena.get_n_sys_nodes() != other_arena.get_n_sys_nodes())
+			fail("numbers of nodes");
+		if(arena.get_n_env_edges() != other_arena.get_n_env_edges() || arena.get_n_sys_edges() != other_arena.get_n_sys_edges())
+			fail("numbers of edges");
+		if(arena.get_initial_node() != other_arena.get_initial_node())
+			fail("initial nodes");
+
+		for (strix_aut::node_id_t env_node = 0; env_node < arena.get_n_env_nodes(); env_node++){
+			if(arena.getEnvSuccsBegin(env_node) != other_arena.getEnvSuccsBegin(env_node) || arena.getEnvSuccsEnd(env_node) != other_arena.getEnvSuccsEnd(env_node))
+				fail("edges of the model nodes");
+			for (strix_aut::edge_id_t env_edge = arena.getEnvSuccsBegin(env_node); env_edge != arena.getEnvSuccsEnd(env_node); env_edge++){
+				const SymbolSpan inputs = arena.getEnvInput(env_edge);
+				const SymbolSpan other_inputs = other_arena.getEnvInput(env_edge);
+				if(arena.getEnvEdge(env_edge) != other_arena.getEnvEdge(env_edge) ||
+				   std::vector<symbolic_t>(inputs.begin(), inputs.end()) != std::vector<symbolic_t>(other_inputs.begin(), other_inputs.end()))
+					fail("edges of the model nodes");
+			}
+		}
+
+		for (strix_aut::node_id_t sys_node = 0; sys_node < arena.get_n_sys_nodes(); sys_node++){
+			if(arena.getSysSuccsBegin(sys_node) != other_arena.getSysSuccsBegin(sys_node) || arena.getSysSuccsEnd(sys_node) != other_arena.getSysSuccsEnd(sys_node))
+				fail("edges of the controller nodes");
+			for (strix_aut::edge_id_t sys_edge = arena.getSysSuccsBegin(sys_node); sys_edge != arena.getSysSuccsEnd(sys_node); sys_edge++){
+				const ControlSet outputs = arena.getSysOutput(sys_edge);
+				const ControlSet other_outputs = other_arena.getSysOutput(sys_edge);
+				if(arena.getSysEdge(sys_edge) != other_arena.getSysEdge(sys_edge) ||
+				   std::vector<symbolic_t>(outputs.begin(), outputs.end()) != std::vector<symbolic_t>(other_outputs.begin(), other_outputs.end()))
+					fail("edges of the controller nodes");
+			}
+		}
+	}
+#endif
+
 	size_t construct_pgame(void* pPackedKernel, void* pPackedParallelProgram){
 		
 		(void)pPackedParallelProgram;
@@ -236,6 +467,30 @@ namespace pFacesOmegaKernels {
 			std::to_string(pKernel->pParityGame->get_n_sys_edges()) + std::string(" controller edges.")
         );
 
+		if(pKernel->pSymSpec->dpa.getStorage() == DpaStorage::LAZY)
+			pfacesTerminal::showInfoMessage(
+				std::string("construct_pgame: ") + 
+				std::to_string(pKernel->pSymSpec->count_DPA_states()) + std::string(" states of the DPA were explored.")
+			);
+
+		if(pKernel->pSymModel->is_posts_cache_enabled() && !pKernel->pSymModel->is_posts_table_built())
+			pfacesTerminal::showInfoMessage(
+				std::string("construct_pgame: the posts of ") + 
+				std::to_string(pKernel->pSymModel->get_n_cached_posts()) + std::string(" of the ") +
+				std::to_string(pKernel->xu_symbols) + std::string(" (x,u) pairs were needed by the PGame.")
+			);
+
+#ifdef TEST_FUNCTION
+		// the other construction (serial or parallel) gives the same arena
+		PGame<post_func_t, L_x_func_t, L_u_func_t> other_arena(
+			*pKernel->pSymSpec, *pKernel->pSymModel, !pKernel->parallel_construction, pKernel->construction_threads);
+		other_arena.constructArena();
+		test_same_arenas(*pKernel->pParityGame, other_arena);
+		pfacesTerminal::showInfoMessage(
+			std::string("Parity game construction test completed successfully!")
+		);
+#endif
+
 		return 0;
 	}
 #endif
@@ -256,6 +511,32 @@ namespace pFacesOmegaKernels {
 		instr_BlockingSyncPoint->setAsBlockingSyncPoint();
 		instrList.push_back(instr_BlockingSyncPoint);
 
+#ifdef TEST_FUNCTION
+		/* a host side function to test the posts of the reached states */
+		std::shared_ptr<pfacesInstruction> instr_hostTestSymPosts = std::make_shared<pfacesInstruction>();
+		instr_hostTestSymPosts->setAsHostFunction(test_sym_posts, "test_sym_posts");
+		instrList.push_back(instr_hostTestSymPosts);
+#endif
+
+		/* a host side function to construct the DPA (needs the discovered APs) */
+		std::shared_ptr<pfacesInstruction> instr_hostConstructDpa = std::make_shared<pfacesInstruction>();
+		instr_hostConstructDpa->setAsHostFunction(construct_dpa, "construct_dpa");
+		instrList.push_back(instr_hostConstructDpa);	
+
+		/* a host side function to tabulate the posts (if requested) */
+		if(posts_table){
+			std::shared_ptr<pfacesInstruction> instr_hostBuildPostsTable = std::make_shared<pfacesInstruction>();
+			instr_hostBuildPostsTable->setAsHostFunction(build_posts_table, "build_posts_table");
+			instrList.push_back(instr_hostBuildPostsTable);
+		}
+
+		/* a host side function to tabulate the predecessors (if requested) */
+		if(pre_table){
+			std::shared_ptr<pfacesInstruction> instr_hostBuildPreTable = std::make_shared<pfacesInstruction>();
+			instr_hostBuildPreTable->setAsHostFunction(build_pre_table, "build_pre_table");
+			instrList.push_back(instr_hostBuildPreTable);
+		}
+
 		/* a host side function to construct the PGame */
 		/* TODO: replace with parallel implementation */
 		std::shared_ptr<pfacesInstruction> instr_hostConstructPGame = std::make_shared<pfacesInstruction>();
@@ -7,27 +7,244 @@
 
 #include "omega.h"
 
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <exception>
+
 namespace pFacesOmegaKernels {
     
 	/* constants to represent the function name and the names of its arguments */
     const concrete_t inf_val = std::numeric_limits<concrete_t>::infinity();
+#ifdef TEST_FUNCTION
+	const cl_uchar compact_posts_unwritten = 0x80;
+#endif
 	const std::string construct_symmodel_func_name = std::string("construct_symmodel");
 	const std::vector<std::string> construct_symmodel_arg_names = {
-		"xu_posts_bags"
+		"xu_posts_bags",
+		"reach_states"
 	};
 
+	/* the binary files of the symbolic model (the written ones and the cached ones): a header, the grid
+	   (lb/ub/quantizers of the states and the controls as concrete_t, then their widths as uint64_t),
+	   the reach set of the states (see reach_symmodel) and the posts of all (x,u) as they are in memory.
+	   each section starts at a 64-byte aligned offset (see interface/python/OmegaInterface.py) */
+	const std::string symmodel_cache_version = "omega-symmodel-3";
+	const char symmodel_file_magic[8] = {'O', 'M', 'E', 'G', 'A', 'S', 'Y', 'M'};
+	const uint64_t symmodel_file_version = 2;
+	const size_t symmodel_file_chunk_size = 64*1024*1024;
+	struct SymModelFileHeader {
+		char magic[8];
+		uint64_t version;
+		uint64_t concrete_size;
+		uint64_t compact_posts;
+		uint64_t x_dim;
+		uint64_t u_dim;
+		uint64_t x_symbols;
+		uint64_t u_symbols;
+		uint64_t size_struct_xu_posts;
+		uint64_t grid_offset;
+		uint64_t reach_offset;
+		uint64_t posts_offset;
+	};
+
+	static uint64_t align_symmodel_section(uint64_t offset){
+		return ((offset + 63)/64)*64;
+	}
+
+	/* the header of the binary file of the symbolic model of the kernel */
+	static SymModelFileHeader get_symmodel_file_header(const pFacesOmega* pKernel){
+		SymModelFileHeader header;
+		std::memcpy(header.magic, symmodel_file_magic, sizeof(header.magic));
+		header.version = symmodel_file_version;
+		header.concrete_size = sizeof(concrete_t);
+		header.compact_posts = pKernel->compact_posts ? 1 : 0;
+		header.x_dim = pKernel->x_dim;
+		header.u_dim = pKernel->u_dim;
+		header.x_symbols = pKernel->x_symbols;
+		header.u_symbols = pKernel->u_symbols;
+		header.size_struct_xu_posts = pKernel->size_struct_xu_posts;
+		header.grid_offset = align_symmodel_section(sizeof(header));
+		header.reach_offset = align_symmodel_section(header.grid_offset + 
+			3*(pKernel->x_dim + pKernel->u_dim)*sizeof(concrete_t) + (pKernel->x_dim + pKernel->u_dim)*sizeof(uint64_t));
+		header.posts_offset = align_symmodel_section(header.reach_offset + pKernel->x_symbols);
+		return header;
+	}
+
+	/* write the symbolic model to a binary file: the header, grid and reach set are written first and
+	   the posts are then written in parallel chunks, each by a thread with its own stream */
+	static void write_symmodel_file(const pFacesOmega* pKernel, const std::string& filename){
+		const SymModelFileHeader header = get_symmodel_file_header(pKernel);
+		const size_t posts_size = pKernel->xu_symbols*pKernel->size_struct_xu_posts;
+		const char zeros[64] = {0};
+
+		std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+		ofs.write((const char*)&header, sizeof(header));
+		ofs.write(zeros, header.grid_offset - sizeof(header));
+		for (const std::vector<concrete_t>* vec : {&pKernel->x_lb, &pKernel->x_ub, &pKernel->x_qs, &pKernel->u_lb, &pKernel->u_ub, &pKernel->u_qs})
+			ofs.write((const char*)vec->data(), vec->size()*sizeof(concrete_t));
+		for (const std::vector<symbolic_t>* widths : {&pKernel->x_widths, &pKernel->u_widths}){
+			for (symbolic_t width : *widths){
+				const uint64_t width_64 = width;
+				ofs.write((const char*)&width_64, sizeof(width_64));
+			}
+		}
+		ofs.write(zeros, header.reach_offset - (size_t)ofs.tellp());
+		ofs.write((const char*)pKernel->reach_states, pKernel->x_symbols);
+		ofs.write(zeros, header.posts_offset - (size_t)ofs.tellp());
+
+		// the file gets its final size so the chunks are written within it
+		if(posts_size > 0){
+			ofs.seekp(header.posts_offset + posts_size - 1);
+			ofs.put(0);
+		}
+		ofs.close();
+		if(!ofs.good())
+			throw std::runtime_error("write_symmodel_file: could not write the file: " + filename);
+
+		work_stealing_for(posts_size, std::max<size_t>(1, std::thread::hardware_concurrency()), symmodel_file_chunk_size, 
+			[&](const size_t first_byte, const size_t last_byte){
+				std::fstream fs(filename, std::ios::binary | std::ios::in | std::ios::out);
+				fs.seekp(header.posts_offset + first_byte);
+				fs.write(pKernel->xu_posts_data + first_byte, last_byte - first_byte);
+				fs.close();
+				if(!fs.good())
+					throw std::runtime_error("write_symmodel_file: could not write the file: " + filename);
+			});
+	}
+
+	/* the streaming of the tiles to the posts file: the tile read last is copied to a staging
+	   memory and written by a writer thread while the device constructs the next tile */
+	static std::ofstream posts_ofs;
+	static std::vector<char> tile_staging;
+	static std::thread tile_writer;
+	static std::exception_ptr tile_writer_error;
+
+	static void wait_tile_writer(){
+		if(tile_writer.joinable())
+			tile_writer.join();
+		if(tile_writer_error)
+			std::rethrow_exception(tile_writer_error);
+	}
+
+	/* the writer is joined when the program exits while a tile is written (e.g. after a device error) */
+	static struct TileWriterJoiner {
+		~TileWriterJoiner(){
+			if(tile_writer.joinable())
+				tile_writer.join();
+		}
+	} tile_writer_joiner;
+
+	/* stop the streaming after an error: the writer is joined and the partial posts file is removed */
+	static void abort_tile_stream(pFacesOmega* pKernel){
+		if(tile_writer.joinable())
+			tile_writer.join();
+		tile_writer_error = nullptr;
+		posts_ofs.close();
+		std::vector<char>().swap(tile_staging);
+		pKernel->pPostsFile.reset();
+		std::remove(pKernel->posts_file.c_str());
+	}
+
+	/* a host-side function to stream a constructed tile of the XU space to the posts file */
+	size_t stream_symmodel_tile(void* pPackedKernel, void* pPackedParallelProgram){
+		static pfacesParallelProgram*  pParallelProgram = (pfacesParallelProgram*)pPackedParallelProgram;
+		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
+
+		size_t buff0Idx = pKernel->getBufferIndex(construct_symmodel_func_name, construct_symmodel_arg_names[0], pKernel->memReport);
+		const char* pData = (const char*)pParallelProgram->m_dataPool[buff0Idx].first;
+
+		try {
+			if(pKernel->symmodel_tiles_streamed == 0){
+				posts_ofs.open(pKernel->posts_file, std::ios::binary | std::ios::trunc);
+				if(!posts_ofs.good())
+					throw std::runtime_error("stream_symmodel_tile: could not open the posts file: " + pKernel->posts_file);
+			}
+
+			// the staging memory is reused once the previous tile is written
+			wait_tile_writer();
+			const size_t tile_x_begin = pKernel->symmodel_tiles_streamed*pKernel->symmodel_tile_x;
+			const size_t tile_x_count = std::min(pKernel->symmodel_tile_x, pKernel->x_symbols - tile_x_begin);
+			tile_staging.assign(pData, pData + tile_x_count*pKernel->u_symbols*pKernel->size_struct_xu_posts);
+			pKernel->symmodel_tiles_streamed++;
+
+			tile_writer = std::thread([](){
+				posts_ofs.write(tile_staging.data(), tile_staging.size());
+				if(!posts_ofs.good())
+					tile_writer_error = std::make_exception_ptr(std::runtime_error("stream_symmodel_tile: could not write the posts file: " + pKernel->posts_file));
+			});
+
+			// all tiles are written: the posts are read from the mapped file
+			if(pKernel->symmodel_tiles_streamed == pKernel->symmodel_tiles){
+				wait_tile_writer();
+				posts_ofs.close();
+				std::vector<char>().swap(tile_staging);
+
+				pKernel->pPostsFile = std::make_shared<MappedFile>(pKernel->posts_file);
+				if(pKernel->pPostsFile->size() != pKernel->xu_symbols*pKernel->size_struct_xu_posts)
+					throw std::runtime_error("stream_symmodel_tile: the posts file has an invalid size: " + pKernel->posts_file);
+				pKernel->xu_posts_data = pKernel->pPostsFile->data();
+#ifndef _WIN32
+				// the mapping keeps the posts once the file is unlinked (else it is removed by ~pFacesOmega)
+				std::remove(pKernel->posts_file.c_str());
+#endif
+			}
+		}
+		catch(...){
+			abort_tile_stream(pKernel);
+			throw;
+		}
+
+		return 0;
+	}
+
+	/* a host-side function to add the constructed symbolic model to the cache */
+	size_t save_symmodel_cache(void* pPackedKernel, void* pPackedParallelProgram){
+		(void)pPackedParallelProgram;
+		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
+
+		const bool cached = OmegaUtils::WriteCacheFile(pKernel->symmodel_cache_file, [&](const std::string& tmp_file){
+			write_symmodel_file(pKernel, tmp_file);
+		});
+		if(!cached)
+			pfacesTerminal::showWarnMessage(std::string("save_symmodel_cache: could not add the symbolic model to the cache: ") + pKernel->symmodel_cache_file);
+		return 0;
+	}
+
 #ifdef TEST_FUNCTION
 	/* a host-side function to retrieve the memory ant test the output */
 	size_t test_construct_symmodel(void* pPackedKernel, void* pPackedParallelProgram){
-		static pfacesParallelProgram*  pParallelProgram = (pfacesParallelProgram*)pPackedParallelProgram;
+		(void)pPackedParallelProgram;
 		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
 
-        size_t buff0Idx = pKernel->getBufferIndex(construct_symmodel_func_name, construct_symmodel_arg_names[0], pKernel->memReport);
-		static concrete_t* pData	= (concrete_t*)pParallelProgram->m_dataPool[buff0Idx].first;
+		// the posts of all tiles (see stream_symmodel_tile)
+		static const concrete_t* pData	= (const concrete_t*)pKernel->xu_posts_data;
+
+		// the flags of the compact posts are initialized with an unused bit
+		if(pKernel->compact_posts){
+			const char* pPosts = (const char*)pData;
+			for (size_t xu_flat=0; xu_flat<pKernel->xu_symbols; xu_flat++){
+				if(pKernel->reach_states[xu_flat/pKernel->u_symbols] == REACH_UNREACHED)
+					continue;
+				if((cl_uchar)pPosts[(xu_flat+1)*pKernel->size_struct_xu_posts - 1] & compact_posts_unwritten){
+					throw std::runtime_error(
+						std::string("test_construct_symmodel: XU element ") +
+						std::to_string(xu_flat) +
+						std::string(" has its compact posts left unwritten.")
+					);
+				}
+			}
+			pfacesTerminal::showInfoMessage(
+				std::string("Symbolic model construction test completed successfully!")
+			);
+			return 0;
+		}
 
         size_t num_cons_in_struct = pKernel->size_struct_xu_posts / sizeof(concrete_t);
         size_t num_xu_concs = pKernel->xu_symbols * num_cons_in_struct;
 		for (size_t i=0; i<num_xu_concs; i++){
+			if(pKernel->reach_states[(i/num_cons_in_struct)/pKernel->u_symbols] == REACH_UNREACHED)
+				continue;
 			if(pData[i] == inf_val){
                 throw std::runtime_error(
                     std::string("test_construct_symmodel: XU element ") +
@@ -49,8 +266,18 @@ namespace pFacesOmegaKernels {
 		static pfacesParallelProgram*  pParallelProgram = (pfacesParallelProgram*)pPackedParallelProgram;
 		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
 
-        size_t buff0Idx = pKernel->getBufferIndex(construct_symmodel_func_name, construct_symmodel_arg_names[0], pKernel->memReport);
-		static concrete_t* pData	= (concrete_t*)pParallelProgram->m_dataPool[buff0Idx].first;
+		// the posts of all tiles (see stream_symmodel_tile)
+		static const concrete_t* pData	= (const concrete_t*)pKernel->xu_posts_data;
+
+		std::string target_file = 
+            pfacesFileIO::getFileDirectoryPath(pParallelProgram->m_spCfgReader->getConfigFilePath()) + 
+            pParallelProgram->m_spCfgReader->readConfigValueString("project_name") + 
+            std::string(".symmodel");
+
+		if(pKernel->symmodel_file_format == SymModelFileFormat::BINARY){
+			write_symmodel_file(pKernel, target_file);
+			return 0;
+		}
 
 		std::stringstream ss_symmoodel;
 		size_t num_cons_in_struct = pKernel->size_struct_xu_posts / sizeof(concrete_t);
@@ -59,6 +286,40 @@ namespace pFacesOmegaKernels {
 				size_t xu_flat = u_flat + x_flat*pKernel->u_symbols;
 				ss_symmoodel << "[x_" << x_flat << "," << "u_" << u_flat << "] => ";
 
+				// the posts of the states out of the reach set are not constructed
+				if(pKernel->reach_states[x_flat] == REACH_UNREACHED){
+					ss_symmoodel << "unreachable" << std::endl;
+					continue;
+				}
+
+				// compact posts: the union of the cells of the post symbols (the same reach boxes as
+				// without compact posts, enlarged to the cells)
+				if(pKernel->compact_posts){
+					const char* pPosts = (const char*)pData + xu_flat*pKernel->size_struct_xu_posts;
+					cl_uint lb_flat;
+					std::memcpy(&lb_flat, pPosts, sizeof(cl_uint));
+					const cl_uchar flags = pPosts[sizeof(cl_uint) + pKernel->x_dim*pKernel->compact_extent_size];
+
+					if(flags & COMPACT_POSTS_OUT_OF_DOMAIN)
+						ss_symmoodel << "out_of_domain";
+					else{
+						for (size_t i=0; i<pKernel->x_dim; i++){
+							symbolic_t post_i_lb = lb_flat % pKernel->x_widths[i];
+							lb_flat /= pKernel->x_widths[i];
+
+							concrete_t eta_i = pKernel->x_qs[i];
+							concrete_t cell_i_lb = pKernel->x_lb[i] + post_i_lb*eta_i - eta_i/2;
+							symbolic_t extent_i = get_compact_posts_extent(pPosts, i, pKernel->compact_extent_size);
+							concrete_t cell_i_ub = pKernel->x_lb[i] + (post_i_lb + extent_i)*eta_i + eta_i/2;
+							ss_symmoodel << "[" << cell_i_lb << "," << cell_i_ub << "]";
+							if(i <  (pKernel->x_dim-1))
+								ss_symmoodel << "x";
+						}
+					}
+					ss_symmoodel << std::endl;
+					continue;
+				}
+
 				for (size_t i=0; i<pKernel->x_dim; i++){
 					concrete_t post_i_lb = pData[xu_flat*num_cons_in_struct + i];
 					concrete_t post_i_ub = pData[xu_flat*num_cons_in_struct + i + pKernel->x_dim];
@@ -72,11 +333,6 @@ namespace pFacesOmegaKernels {
 			}	
 		}
 
-		std::string target_file = 
-            pfacesFileIO::getFileDirectoryPath(pParallelProgram->m_spCfgReader->getConfigFilePath()) + 
-            pParallelProgram->m_spCfgReader->readConfigValueString("project_name") + 
-            std::string(".symmodel");
-
 		pfacesFileIO::writeTextToFile(target_file, ss_symmoodel.str(), false);
 		return 0;
 	}
@@ -84,8 +340,82 @@ namespace pFacesOmegaKernels {
 	/* to init the function */
 	void pFacesOmega::init_construct_symmodel(){
 
-		// size of the xu_posts struct in bytes
-		size_struct_xu_posts = 2 * x_dim * sizeof(concrete_t);
+		// size of the xu_posts struct in bytes: the concrete reach box or the compact posts
+		// (see omega_symmodel.cl) that index the post symbols with 32-bit flat indices. the
+		// extents of the compact posts are as wide as the widest dimension of the states needs.
+		// with the reachability pre-pass (see reach_symmodel), the posts are always the compact
+		// ones: the host reads the post symbols the device marked as reached instead of
+		// quantizing the reach boxes again (with a division that may round differently)
+		const size_t reachability_waves = m_spCfg->readConfigValueInt("system.reachability_waves");
+		compact_posts = m_spCfg->readConfigValueBool("system.compact_posts") || reachability_waves > 0;
+		if(compact_posts && x_symbols > std::numeric_limits<cl_uint>::max())
+			throw std::runtime_error("pFacesOmega::init_construct_symmodel: too many state symbols for the compact posts (system.compact_posts or system.reachability_waves).");
+		const symbolic_t max_x_width = *std::max_element(x_widths.begin(), x_widths.end());
+		if(max_x_width - 1 <= std::numeric_limits<cl_uchar>::max())
+			compact_extent_size = sizeof(cl_uchar);
+		else if(max_x_width - 1 <= std::numeric_limits<cl_ushort>::max())
+			compact_extent_size = sizeof(cl_ushort);
+		else
+			compact_extent_size = sizeof(cl_uint);
+		if(compact_posts)
+			size_struct_xu_posts = sizeof(cl_uint) + x_dim * compact_extent_size + sizeof(cl_uchar);
+		else
+			size_struct_xu_posts = 2 * x_dim * sizeof(concrete_t);
+
+		// a symbolic model constructed before from the same dynamics and quantization is loaded from
+		// the cache (if any). the key hashes the code file, its defines, the step time, the quantization,
+		// the layout of the posts and, with the reachability pre-pass, the initial set
+		std::string symmodel_cache_dir = m_spCfg->readConfigValueString("system.symmodel_cache_dir");
+		if(!symmodel_cache_dir.empty()){
+			symmodel_cache_dir = pfacesFileIO::getFileDirectoryPath(m_spCfg->getConfigFilePath()) + symmodel_cache_dir;
+			if(symmodel_cache_dir.back() != '/' && symmodel_cache_dir.back() != '\\')
+				symmodel_cache_dir += std::string(PFACES_PATH_SPLITTER);
+
+			// the fields are separated by a zero byte and the vectors are hashed as they are in memory
+			std::stringstream ss;
+			ss << symmodel_cache_version << '\0' << pfacesFileIO::readTextFromFile(code_file) << '\0';
+			ss << m_spCfg->readConfigValueString("system.dynamics.code_defines") << '\0';
+			ss << m_spCfg->readConfigValueString("system.dynamics.step_time") << '\0';
+			for (const std::vector<concrete_t>* vec : {&x_lb, &x_ub, &x_qs, &u_lb, &u_ub, &u_qs}){
+				ss << vec->size() << '\0';
+				ss.write((const char*)vec->data(), vec->size()*sizeof(concrete_t));
+			}
+			ss << sizeof(concrete_t) << '\0' << compact_posts << '\0';
+			if(reachability_waves > 0)
+				ss << m_spCfg->readConfigValueString("system.states.initial_set") << '\0' << reachability_waves;
+
+			symmodel_cache_file = symmodel_cache_dir + OmegaUtils::HashKey(ss.str()) + std::string(".symcache");
+			symmodel_cache_hit = pfacesFileIO::isFileExist(symmodel_cache_file);
+		}
+
+		// the format of the written symbolic model (see system.write_symmodel)
+		std::string str_symmodel_file_format = m_spCfg->readConfigValueString("system.symmodel_file_format");
+		if(str_symmodel_file_format == std::string("text"))
+			symmodel_file_format = SymModelFileFormat::TEXT;
+		else if(str_symmodel_file_format == std::string("binary"))
+			symmodel_file_format = SymModelFileFormat::BINARY;
+		else
+			throw std::runtime_error("pFacesOmega::init_construct_symmodel: invalid symbolic model file format (system.symmodel_file_format) in the config file.");
+
+		// the XU space is constructed in tiles of x symbols (each with all u symbols) when its posts
+		// exceed the memory budget (in MB). the tiles are streamed to a posts file that is mapped
+		const size_t posts_memory_budget = (size_t)m_spCfg->readConfigValueInt("system.posts_memory_budget")*1024*1024;
+		symmodel_tile_x = x_symbols;
+		if(!symmodel_cache_hit && posts_memory_budget > 0 && xu_symbols*size_struct_xu_posts > posts_memory_budget){
+			symmodel_tile_x = posts_memory_budget/(u_symbols*size_struct_xu_posts);
+			if(symmodel_tile_x == 0)
+				throw std::runtime_error("pFacesOmega::init_construct_symmodel: the memory budget (system.posts_memory_budget) can not hold the posts of one state symbol.");
+		}
+		symmodel_tiles = (x_symbols + symmodel_tile_x - 1)/symmodel_tile_x;
+		posts_file = 
+			pfacesFileIO::getFileDirectoryPath(m_spCfg->getConfigFilePath()) + 
+			m_spCfg->readConfigValueString("project_name") + 
+			std::string(".posts");
+		if(symmodel_tiles > 1)
+			pfacesTerminal::showInfoMessage(
+				std::string("Symbolic model: the XU-space is constructed in ") + std::to_string(symmodel_tiles) + 
+				std::string(" tiles of ") + std::to_string(symmodel_tile_x) + std::string(" state symbols.")
+			);
 
 		// get the initial state
 		auto initial_hrs = OmegaUtils::extractHyperrects(m_spCfg->readConfigValueString("system.states.initial_set"), x_dim);
@@ -109,42 +439,90 @@ namespace pFacesOmegaKernels {
     	func_info_construct_symmodel = 
         	std::make_pair<std::string, std::vector<arg_info>>(
 				construct_symmodel_func_name.c_str(), {
-					std::make_tuple(construct_symmodel_arg_names[0], size_struct_xu_posts, xu_symbols)
+					std::make_tuple(construct_symmodel_arg_names[0], size_struct_xu_posts, symmodel_tile_x*u_symbols),
+					std::make_tuple(construct_symmodel_arg_names[1], sizeof(cl_uchar), x_symbols)
 				});
 
 		/* init any required params */
 		param_values.push_back(m_spCfg->readConfigValueString("system.dynamics.step_time"));
 		param_names.push_back("@@STEP_TIME@@");    
+		param_values.push_back(compact_posts ? "1" : "0");
+		param_names.push_back("@@COMPACT_POSTS@@");
+		param_values.push_back(compact_extent_size == sizeof(cl_uchar) ? "uchar" : (compact_extent_size == sizeof(cl_ushort) ? "ushort" : "uint"));
+		param_names.push_back("@@COMPACT_EXTENT_T@@");
 	}
 
 	/* add the function to the instruction list */
     void pFacesOmega::add_func_construct_symmodel(std::vector<std::shared_ptr<pfacesInstruction>>& instrList, const cl::Device& targetDevice){
 
-		// index of the function and number of its arguments in the kernel
-		size_t funcIdx = getKernelFunctionIndex(func_info_construct_symmodel.first);
-		size_t numArgs = func_info_construct_symmodel.second.size();
+		/* a cached symbolic model is mapped (see init_mem_construct_symmodel) and not constructed */
+		if(symmodel_cache_hit){
+			std::shared_ptr<pfacesInstruction> instrMsg_cached_symmodel = std::make_shared<pfacesInstruction>();
+			instrMsg_cached_symmodel->setAsMessage("The symbolic model is loaded from the cache.");
+			instrList.push_back(instrMsg_cached_symmodel);
+		}
+		else {
+			// index of the function and number of its arguments in the kernel
+			size_t funcIdx = getKernelFunctionIndex(func_info_construct_symmodel.first);
+			size_t numArgs = func_info_construct_symmodel.second.size();
+
+			/* a message to declare start of execution */
+			std::shared_ptr<pfacesInstruction> instrMsg_start_construct_symmodel = std::make_shared<pfacesInstruction>();
+			instrMsg_start_construct_symmodel->setAsMessage("Constructing the symbolic model in parallel ... ");
+			instrList.push_back(instrMsg_start_construct_symmodel);	
+
+			/* write the reach set (see reach_symmodel) */
+			std::shared_ptr<pfacesInstruction> instr_writeArg1 = std::make_shared<pfacesInstruction>();
+			instr_writeArg1->setAsWriteDeviceBuffer(
+				std::make_shared<pfacesDeviceWriteJob>(targetDevice, funcIdx, numArgs, 1));
+			instrList.push_back(instr_writeArg1);
+
+			for (size_t tile = 0; tile < symmodel_tiles; tile++){
+
+				/* an execute-instruction to launch parallel threads in the device (for the x symbols of the tile) */
+				const size_t tile_x_begin = tile*symmodel_tile_x;
+				const size_t tile_x_count = std::min(symmodel_tile_x, x_symbols - tile_x_begin);
+				auto null_range = cl::NullRange;
+				auto tile_offset = (symmodel_tiles == 1 ? ndKernelOffset : cl::NDRange(tile_x_begin, 0, 0));
+				auto tile_range = (symmodel_tiles == 1 ? ndKernelRange_XU : cl::NDRange(tile_x_count, u_symbols, 1));
+				std::shared_ptr<pfacesDeviceExecuteTask> task = std::make_shared<pfacesDeviceExecuteTask>(tile_offset, tile_range, null_range);
+				std::shared_ptr<pfacesDeviceExecuteJob> job = std::make_shared<pfacesDeviceExecuteJob>(targetDevice);
+				job->addTask(task);
+				job->setKernelFunctionIdx(funcIdx, numArgs);		
+				std::shared_ptr<pfacesInstruction> devFunctionInstruction = std::make_shared<pfacesInstruction>();
+				devFunctionInstruction->setAsDeviceExecute(job);
+				instrList.push_back(devFunctionInstruction);
+
+
+				/* read the result memory buffer */
+				std::shared_ptr<pfacesInstruction> instr_readArg0 = std::make_shared<pfacesInstruction>();
+				instr_readArg0->setAsReadDeviceBuffer(
+					std::make_shared<pfacesDeviceReadJob>(targetDevice, funcIdx, numArgs, 0));
+				instrList.push_back(instr_readArg0);
 
-		/* a message to declare start of execution */
-		std::shared_ptr<pfacesInstruction> instrMsg_start_construct_symmodel = std::make_shared<pfacesInstruction>();
-		instrMsg_start_construct_symmodel->setAsMessage("Constructing the symbolic model in parallel ... ");
-		instrList.push_back(instrMsg_start_construct_symmodel);	
+				/* stream the tile to the posts file (while the next tile is constructed) */
+				if(symmodel_tiles > 1){
+					std::shared_ptr<pfacesInstruction> instr_TileSyncPoint = std::make_shared<pfacesInstruction>();
+					instr_TileSyncPoint->setAsBlockingSyncPoint();
+					instrList.push_back(instr_TileSyncPoint);
 
-		/* an execute-instruction to launch parallel threads in the device */
-		auto null_range = cl::NullRange;
-		std::shared_ptr<pfacesDeviceExecuteTask> task = std::make_shared<pfacesDeviceExecuteTask>(ndKernelOffset, ndKernelRange_XU, null_range);
-		std::shared_ptr<pfacesDeviceExecuteJob> job = std::make_shared<pfacesDeviceExecuteJob>(targetDevice);
-		job->addTask(task);
-		job->setKernelFunctionIdx(funcIdx, numArgs);		
-		std::shared_ptr<pfacesInstruction> devFunctionInstruction = std::make_shared<pfacesInstruction>();
-		devFunctionInstruction->setAsDeviceExecute(job);
-		instrList.push_back(devFunctionInstruction);
+					std::shared_ptr<pfacesInstruction> instr_streamTile = std::make_shared<pfacesInstruction>();
+					instr_streamTile->setAsHostFunction(stream_symmodel_tile, "stream_symmodel_tile");
+					instrList.push_back(instr_streamTile);
+				}
+			}
 
+			/* add the constructed symbolic model to the cache */
+			if(!symmodel_cache_file.empty()){
+				std::shared_ptr<pfacesInstruction> instr_CacheSyncPoint = std::make_shared<pfacesInstruction>();
+				instr_CacheSyncPoint->setAsBlockingSyncPoint();
+				instrList.push_back(instr_CacheSyncPoint);
 
-		/* read the result memory buffer */
-		std::shared_ptr<pfacesInstruction> instr_readArg0 = std::make_shared<pfacesInstruction>();
-		instr_readArg0->setAsReadDeviceBuffer(
-			std::make_shared<pfacesDeviceReadJob>(targetDevice, funcIdx, numArgs, 0));
-		instrList.push_back(instr_readArg0);
+				std::shared_ptr<pfacesInstruction> instr_saveCache = std::make_shared<pfacesInstruction>();
+				instr_saveCache->setAsHostFunction(save_symmodel_cache, "save_symmodel_cache");
+				instrList.push_back(instr_saveCache);
+			}
+		}
 
 #ifdef TEST_FUNCTION
 		/* a sync point */
@@ -181,12 +559,49 @@ namespace pFacesOmegaKernels {
 
 	/* to init the function memory */
     void pFacesOmega::init_mem_construct_symmodel(){
+
+		// a cached symbolic model is mapped: the reach set and the posts are read from the file
+		if(symmodel_cache_hit){
+			pSymModelCacheFile = std::make_shared<MappedFile>(symmodel_cache_file);
+			const SymModelFileHeader expected_header = get_symmodel_file_header(this);
+			SymModelFileHeader header;
+			if(pSymModelCacheFile->size() < sizeof(header))
+				throw std::runtime_error("pFacesOmega::init_mem_construct_symmodel: the cached symbolic model is invalid: " + symmodel_cache_file);
+			std::memcpy(&header, pSymModelCacheFile->data(), sizeof(header));
+			if(std::memcmp(&header, &expected_header, sizeof(header)) != 0 ||
+				header.posts_offset + xu_symbols*size_struct_xu_posts != pSymModelCacheFile->size())
+				throw std::runtime_error("pFacesOmega::init_mem_construct_symmodel: the cached symbolic model is invalid: " + symmodel_cache_file);
+
+			reach_states = (const cl_uchar*)(pSymModelCacheFile->data() + header.reach_offset);
+			xu_posts_data = pSymModelCacheFile->data() + header.posts_offset;
+			pfacesTerminal::showInfoMessage(std::string("Symbolic model: the posts are mapped from the cache file: ") + symmodel_cache_file);
+			return;
+		}
+
+		// without tiles, the posts are read from the buffer itself
+		if(symmodel_tiles == 1){
+			size_t buffIdx = getBufferIndex(construct_symmodel_func_name, construct_symmodel_arg_names[0], memReport);
+			xu_posts_data = (const char*)dataPool[buffIdx].first;
+		}
+
+		// all the states are in the reach set unless the reachability pre-pass restricts it
+		size_t buff1Idx = getBufferIndex(construct_symmodel_func_name, construct_symmodel_arg_names[1], memReport);
+		std::memset(dataPool[buff1Idx].first, REACH_REACHED, x_symbols);
+		reach_states = (const cl_uchar*)dataPool[buff1Idx].first;
+
 #ifdef TEST_FUNCTION
-    	// INF to all values
+    	// INF to all values (or the unwritten bit to all the flags of the compact posts)
 		size_t buff0Idx = getBufferIndex(construct_symmodel_func_name, construct_symmodel_arg_names[0], memReport);
 		concrete_t* pBuff0 = (concrete_t*)dataPool[buff0Idx].first;
 
-        size_t num_xu_concs = xu_symbols*(size_struct_xu_posts/sizeof(concrete_t));
+		if(compact_posts){
+			char* pPosts = (char*)pBuff0;
+			for (size_t xu_flat=0; xu_flat<symmodel_tile_x*u_symbols; xu_flat++)
+				pPosts[(xu_flat+1)*size_struct_xu_posts - 1] = (char)compact_posts_unwritten;
+			return;
+		}
+
+        size_t num_xu_concs = symmodel_tile_x*u_symbols*(size_struct_xu_posts/sizeof(concrete_t));
 		for (size_t i=0; i<num_xu_concs; i++){
 			pBuff0[i] = inf_val;
 		}
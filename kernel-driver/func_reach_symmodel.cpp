@@ -0,0 +1,160 @@
+/*
+ * func_reach_symmodel.cpp
+ *
+ *  Created on: 17.10.2026
+ */
+
+#include "omega.h"
+
+#include <cstring>
+
+namespace pFacesOmegaKernels {
+
+	/* constants to represent the function name and the names of its arguments */
+	const std::string reach_symmodel_func_name = std::string("reach_symmodel");
+	const std::vector<std::string> reach_symmodel_arg_names = {
+		"reach_states",
+		"reach_expanded"
+	};
+
+	/* a host-side function to check the reach set computed by the waves and hand it to construct_symmodel */
+	size_t finish_reach_symmodel(void* pPackedKernel, void* pPackedParallelProgram){
+		static pfacesParallelProgram*  pParallelProgram = (pfacesParallelProgram*)pPackedParallelProgram;
+		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
+
+		size_t buff0Idx = pKernel->getBufferIndex(reach_symmodel_func_name, reach_symmodel_arg_names[0], pKernel->memReport);
+		size_t buff1Idx = pKernel->getBufferIndex(reach_symmodel_func_name, reach_symmodel_arg_names[1], pKernel->memReport);
+		const cl_uchar* pReachStates = (const cl_uchar*)pParallelProgram->m_dataPool[buff0Idx].first;
+		const cl_uint* pReachExpanded = (const cl_uint*)pParallelProgram->m_dataPool[buff1Idx].first;
+
+		// the waves converged if all the (x,u) of the reached states are expanded
+		size_t reachable_states = 0;
+		bool converged = true;
+		for (size_t x_flat = 0; x_flat < pKernel->x_symbols && converged; x_flat++){
+			if(pReachStates[x_flat] == REACH_UNREACHED)
+				continue;
+
+			reachable_states++;
+			for (size_t u_flat = 0; u_flat < pKernel->u_symbols; u_flat++){
+				size_t xu_flat = u_flat + x_flat*pKernel->u_symbols;
+				if(!(pReachExpanded[xu_flat/32] & (1u << (xu_flat % 32)))){
+					converged = false;
+					break;
+				}
+			}
+		}
+
+		// otherwise, the reach set is not closed and the whole X-space is constructed
+		if(!converged){
+			pfacesTerminal::showWarnMessage(
+				std::string("Symbolic model: the reachability pre-pass did not converge in ") + std::to_string(pKernel->reach_waves) +
+				std::string(" waves (system.reachability_waves). The whole X-space is constructed.")
+			);
+			return 0;
+		}
+
+		size_t buffReachIdx = pKernel->getBufferIndex(construct_symmodel_func_name, construct_symmodel_arg_names[1], pKernel->memReport);
+		std::memcpy(pParallelProgram->m_dataPool[buffReachIdx].first, pReachStates, pKernel->x_symbols);
+		pfacesTerminal::showInfoMessage(
+			std::string("Symbolic model: ") + std::to_string(reachable_states) + std::string(" of the ") +
+			std::to_string(pKernel->x_symbols) + std::string(" state symbols are reachable from the initial set.")
+		);
+		return 0;
+	}
+
+	/* to init the function */
+	void pFacesOmega::init_reach_symmodel(){
+
+		// the number of waves of the pre-pass (zero to construct the whole X-space). a symbolic
+		// model loaded from the cache comes with its reach set
+		reach_waves = m_spCfg->readConfigValueInt("system.reachability_waves");
+		if(reach_waves == 0 || symmodel_cache_hit){
+			reach_waves = 0;
+			return;
+		}
+
+		// fill the func info
+		func_info_reach_symmodel =
+			std::make_pair<std::string, std::vector<arg_info>>(
+				reach_symmodel_func_name.c_str(), {
+					std::make_tuple(reach_symmodel_arg_names[0], sizeof(cl_uchar), x_symbols),
+					std::make_tuple(reach_symmodel_arg_names[1], sizeof(cl_uint), (xu_symbols + 31)/32)
+				});
+	}
+
+	/* add the function to the instruction list */
+	void pFacesOmega::add_func_reach_symmodel(std::vector<std::shared_ptr<pfacesInstruction>>& instrList, const cl::Device& targetDevice){
+
+		if(reach_waves == 0)
+			return;
+
+		// index of the function and number of its arguments in the kernel
+		size_t funcIdx = getKernelFunctionIndex(func_info_reach_symmodel.first);
+		size_t numArgs = func_info_reach_symmodel.second.size();
+
+		/* a message to declare start of execution */
+		std::shared_ptr<pfacesInstruction> instrMsg_start_reach_symmodel = std::make_shared<pfacesInstruction>();
+		instrMsg_start_reach_symmodel->setAsMessage("Computing, in parallel, the states reachable from the initial set ... ");
+		instrList.push_back(instrMsg_start_reach_symmodel);
+
+		/* write the memory buffers */
+		std::shared_ptr<pfacesInstruction> instr_writeArg0 = std::make_shared<pfacesInstruction>();
+		std::shared_ptr<pfacesInstruction> instr_writeArg1 = std::make_shared<pfacesInstruction>();
+		instr_writeArg0->setAsWriteDeviceBuffer(
+			std::make_shared<pfacesDeviceWriteJob>(targetDevice, funcIdx, numArgs, 0));
+		instr_writeArg1->setAsWriteDeviceBuffer(
+			std::make_shared<pfacesDeviceWriteJob>(targetDevice, funcIdx, numArgs, 1));
+		instrList.push_back(instr_writeArg0);
+		instrList.push_back(instr_writeArg1);
+
+		/* an execute-instruction per wave (the waves after convergence have nothing to expand) */
+		for (size_t wave = 0; wave < reach_waves; wave++){
+			auto null_range = cl::NullRange;
+			std::shared_ptr<pfacesDeviceExecuteTask> task = std::make_shared<pfacesDeviceExecuteTask>(ndKernelOffset, ndKernelRange_XU, null_range);
+			std::shared_ptr<pfacesDeviceExecuteJob> job = std::make_shared<pfacesDeviceExecuteJob>(targetDevice);
+			job->addTask(task);
+			job->setKernelFunctionIdx(funcIdx, numArgs);
+			std::shared_ptr<pfacesInstruction> devFunctionInstruction = std::make_shared<pfacesInstruction>();
+			devFunctionInstruction->setAsDeviceExecute(job);
+			instrList.push_back(devFunctionInstruction);
+		}
+
+		/* read the result memory buffers */
+		std::shared_ptr<pfacesInstruction> instr_readArg0 = std::make_shared<pfacesInstruction>();
+		std::shared_ptr<pfacesInstruction> instr_readArg1 = std::make_shared<pfacesInstruction>();
+		instr_readArg0->setAsReadDeviceBuffer(
+			std::make_shared<pfacesDeviceReadJob>(targetDevice, funcIdx, numArgs, 0));
+		instr_readArg1->setAsReadDeviceBuffer(
+			std::make_shared<pfacesDeviceReadJob>(targetDevice, funcIdx, numArgs, 1));
+		instrList.push_back(instr_readArg0);
+		instrList.push_back(instr_readArg1);
+
+		/* a sync point */
+		std::shared_ptr<pfacesInstruction> instr_BlockingSyncPoint = std::make_shared<pfacesInstruction>();
+		instr_BlockingSyncPoint->setAsBlockingSyncPoint();
+		instrList.push_back(instr_BlockingSyncPoint);
+
+		/* a host side function to check the reach set */
+		std::shared_ptr<pfacesInstruction> instr_finishReach = std::make_shared<pfacesInstruction>();
+		instr_finishReach->setAsHostFunction(finish_reach_symmodel, "finish_reach_symmodel");
+		instrList.push_back(instr_finishReach);
+	}
+
+	/* to init the function memory */
+	void pFacesOmega::init_mem_reach_symmodel(){
+
+		if(reach_waves == 0)
+			return;
+
+		// the initial states are the first wave
+		size_t buff0Idx = getBufferIndex(reach_symmodel_func_name, reach_symmodel_arg_names[0], memReport);
+		cl_uchar* pBuff0 = (cl_uchar*)dataPool[buff0Idx].first;
+		std::memset(pBuff0, REACH_UNREACHED, x_symbols);
+		for (symbolic_t x : initial_states)
+			pBuff0[x] = REACH_REACHED;
+
+		// nothing is expanded
+		size_t buff1Idx = getBufferIndex(reach_symmodel_func_name, reach_symmodel_arg_names[1], memReport);
+		std::memset(dataPool[buff1Idx].first, 0, ((xu_symbols + 31)/32)*sizeof(cl_uint));
+	}
+}
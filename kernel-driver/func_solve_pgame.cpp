@@ -12,14 +12,17 @@ namespace pFacesOmegaKernels {
     /* to init the function */
     void pFacesOmega::init_solve_pgame(){
 
-		// create the parity game solver
-        pParityGameSolver = std::make_shared<PGSISolver<post_func_t, L_x_func_t, L_u_func_t>>(*pParityGame);
+		// the parity game solver is created in solve_pgame as the parity game
+		// is only created (after the DPA) at run time
     }
 
 	size_t solve_pgame(void* pPackedKernel, void* pPackedParallelProgram){
         
         (void)pPackedParallelProgram;
 		static pFacesOmega* pKernel = (pFacesOmega*)pPackedKernel;
+
+		// create the parity game solver
+		pKernel->pParityGameSolver = std::make_shared<PGSISolver<post_func_t, L_x_func_t, L_u_func_t>>(*pKernel->pParityGame);
 		pKernel->pParityGameSolver->solve();
 		strix_aut::Player winner = pKernel->pParityGameSolver->getWinner();
 		if(winner == strix_aut::Player::SYS_PLAYER){
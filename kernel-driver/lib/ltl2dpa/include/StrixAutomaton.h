@@ -23,7 +23,7 @@
 #include <iostream>
 #include <tuple>
 #include <set>
-#include <condition_variable>
+#include <memory>
 
 #include "cuddObj.hh"
 #include "StrixOwl.h"
@@ -162,7 +162,7 @@ namespace strix_aut {
                     }
                 }
 
-                BDD toBDD(Cudd manager, std::vector<int>& bdd_mapping, int32_t pos) {
+                BDD toBDD(Cudd manager, std::vector<int>& bdd_mapping, int32_t pos) const {
                     if (pos < 0) {
                         node_id_t succ = leaves[-pos-1].successor;
                         if (succ == NODE_BOTTOM) {
@@ -183,7 +183,7 @@ namespace strix_aut {
                     }
                 }
 
-                BDD toBDD(Cudd manager, std::vector<int>& bdd_mapping) {
+                BDD toBDD(Cudd manager, std::vector<int>& bdd_mapping) const {
                     if (tree.empty()) {
                         return toBDD(manager, bdd_mapping, -1);
                     }
@@ -204,38 +204,44 @@ namespace strix_aut {
             const Parity parity;
             const ParityType parity_type;
             bool has_safety_filter;
-            std::vector< SuccessorCache > successors;
             letter_t alphabet_size;
             letter_t max_number_successors;
             sized_int_array_t owl_nodes;
             sized_int_array_t owl_leaves;
             sized_double_array_t owl_scores;
 
-            // queue for querying for successors
-            std::queue<node_id_t> queries;
+            // the successors of the local states. an entry is published once (and never changed
+            // afterwards) in segments (segment s holds the local states [2^s-1, 2^(s+1)-1)) that never
+            // move, so the successors found in the cache are read without locking
+            static constexpr size_t N_SEGMENTS = 32;
+            std::atomic<std::atomic<const SuccessorCache*>*> successors[N_SEGMENTS];
 
-            // mutex for accessing the queue for queries
+            // mutex for the cache misses: querying OWL (and its output arrays above) and publishing
             std::mutex query_mutex;
 
-            // mutex for accessing the successors
-            std::mutex successors_mutex;
-
-            // flag if the consumer thread currently has the lock on successors
-            bool has_lock;
-
-            // condition variable signalling new queries or complete construction
-            std::condition_variable change;
-
-            // condition variable signalling new successors
-            std::condition_variable new_successors;
+            static size_t segment_of(const node_id_t local_state) {
+                size_t v = (size_t)local_state + 1;
+                size_t segment = 0;
+                if (v >> 16) { v >>= 16; segment += 16; }
+                if (v >> 8) { v >>= 8; segment += 8; }
+                if (v >> 4) { v >>= 4; segment += 4; }
+                if (v >> 2) { v >>= 2; segment += 2; }
+                if (v >> 1) { segment += 1; }
+                return segment;
+            }
 
-            // variable signalling that the automaton is completely constructed
-            std::atomic<bool> complete;
+            // the cached successors of a local state (nullptr if not there yet)
+            inline const SuccessorCache* find_successors(const node_id_t local_state) const {
+                const size_t segment = segment_of(local_state);
+                const std::atomic<const SuccessorCache*>* entries = successors[segment].load(std::memory_order_acquire);
+                if (entries == nullptr) {
+                    return nullptr;
+                }
+                return entries[(size_t)local_state + 1 - ((size_t)1 << segment)].load(std::memory_order_acquire);
+            }
 
-            void add_new_query(node_id_t query);
-            void wait_for_query(node_id_t& query);
-            void add_new_states();
-            void add_successors(node_id_t local_state);
+            const SuccessorCache* add_successors(node_id_t local_state);
+            const SuccessorCache* query_successors(node_id_t local_state, JVM owl_thread);
 
             color_t initMaxColor() const;
             color_t initDefaultColor() const;
@@ -253,6 +259,16 @@ namespace strix_aut {
 
             ScoredEdge getSuccessor(node_id_t local_state, letter_t letter);
 
+            // queries OWL for the successors of local states (the ones not in the cache yet) under
+            // one lock. once they are there, getSuccessor of the local states does not lock nor call OWL
+            void prepareSuccessors(node_id_t local_state);
+            void prepareSuccessors(const std::vector<node_id_t>& local_states);
+
+            // queries the successors of all the local states reachable from the initial one. the
+            // queries go through owl_thread, the calling thread attached to the OWL isolate
+            void constructStates(JVM owl_thread);
+            Isolate getIsolate() const;
+
             bool hasSafetyFilter();
             BDD getSafetyFilter(Cudd manager, std::vector<int>& bdd_mapping);
 
@@ -463,6 +479,19 @@ namespace strix_aut {
             product_state_t getInitialState() const;
             ColorScore getSuccessor(const product_state_t& state, product_state_t& new_state, letter_t letter);
 
+            // prepares the successors of all leaves for a product state (or a range of them, with one
+            // batch of queries per leaf). must be called from the thread owning the OWL isolate.
+            // afterwards, getSuccessor of these product states does not call OWL and can run
+            // concurrently from many threads
+            void prepareSuccessors(const product_state_t& state);
+            void prepareSuccessors(std::vector<product_state_t>::const_iterator first, std::vector<product_state_t>::const_iterator last);
+
+            // constructs all the reachable local states of the leaf automata, concurrently with up to
+            // n_threads worker threads (each attached to the OWL isolate and taking whole automata).
+            // must be called from the thread owning the OWL isolate while nothing else queries the
+            // automata. afterwards, getSuccessor never calls OWL
+            void constructAutomata(size_t n_threads);
+
             BDD computeSafetyFilter(Cudd manager, size_t var_begin, size_t var_end);
 
             std::vector<int> getAutomatonStates(const product_state_t& state) const;
@@ -4,6 +4,7 @@
 #include <bitset>
 #include <cmath>
 #include <cassert>
+#include <exception>
 
 #include "StrixAutomaton.h"
 
@@ -55,12 +56,11 @@ namespace strix_aut {
         parity_type(initParityType()),
         has_safety_filter(initSafetyFilter()),
         alphabet_size(0),
-        max_number_successors(0),
-        has_lock(false),
-        complete(false)
+        max_number_successors(0)
     {
-        // reserve some space in the vector to avoid initial resizing, which needs locking for the parallel construction
-        successors.reserve(4096);
+        for (auto& segment : successors) {
+            segment.store(nullptr);
+        }
 
         owl_nodes.elements = nullptr;
         owl_leaves.elements = nullptr;
@@ -72,6 +72,16 @@ namespace strix_aut {
             destroy_object_handle(owl, automaton);
             automaton = nullptr;
         }
+        for (size_t segment = 0; segment < N_SEGMENTS; segment++) {
+            std::atomic<const SuccessorCache*>* entries = successors[segment].load();
+            if (entries == nullptr) {
+                continue;
+            }
+            for (size_t i = 0; i < ((size_t)1 << segment); i++) {
+                delete entries[i].load();
+            }
+            delete[] entries;
+        }
     }
 
     void Automaton::setAlphabetSize(const letter_t _alphabet_size) {
@@ -182,130 +192,140 @@ namespace strix_aut {
         return parity;
     }
 
-    void Automaton::add_new_query(node_id_t query) {
-        std::unique_lock<std::mutex> lock(query_mutex);
-        queries.push(query);
-        query_mutex.unlock();
-        change.notify_all();
-    }
-
-    void Automaton::wait_for_query(node_id_t& query) {
-        std::unique_lock<std::mutex> lock(query_mutex);
-        while(!complete && queries.empty()) {
-            change.wait(lock);
-        }
-        if (!queries.empty()) {
-            query = queries.front();
-            queries.pop();
+    const Automaton::SuccessorCache* Automaton::add_successors(node_id_t local_state) {
+        std::lock_guard<std::mutex> lock(query_mutex);
+        const SuccessorCache* cache = find_successors(local_state);
+        if (cache == nullptr) {
+            cache = query_successors(local_state, owl);
         }
+        return cache;
     }
 
-    void Automaton::add_new_states() {
-        while (!complete) {
-            node_id_t query = NODE_BOTTOM;
-            wait_for_query(query);
-            if (query != NODE_BOTTOM) {
-                add_successors(query);
+    // the caller holds the query_mutex and the local state is not in the cache
+    const Automaton::SuccessorCache* Automaton::query_successors(node_id_t local_state, JVM owl_thread) {
+        const size_t segment = segment_of(local_state);
+        std::atomic<const SuccessorCache*>* entries = successors[segment].load(std::memory_order_relaxed);
+        if (entries == nullptr) {
+            const size_t segment_size = (size_t)1 << segment;
+            entries = new std::atomic<const SuccessorCache*>[segment_size];
+            for (size_t i = 0; i < segment_size; i++) {
+                entries[i].store(nullptr, std::memory_order_relaxed);
             }
-        }
-    }
-
-    void Automaton::add_successors(node_id_t local_state) {
-        if (local_state >= successors.size()) {
-            /*
-            if (successors.capacity() >= local_state + 1) {
-                successors_mutex.lock();
-                has_lock = true;
+            successors[segment].store(entries, std::memory_order_release);
+        }
+
+        std::unique_ptr<SuccessorCache> cache(new SuccessorCache());
+        automaton_edge_tree(owl_thread, automaton,
+                local_state,
+                &owl_nodes, &owl_leaves, &owl_scores);
+
+        cache->tree.reserve(owl_nodes.length);
+        cache->tree.insert(cache->tree.end(), owl_nodes.elements, owl_nodes.elements + owl_nodes.length);
+
+        cache->leaves.reserve(owl_leaves.length);
+        for (int i = 0; i < owl_leaves.length; i += 2) {
+            node_id_t successor_state;
+            int32_t state = owl_leaves.elements [i];
+            int32_t color = owl_leaves.elements [i + 1];
+            double score = owl_scores.elements [i/2];
+            if (state == -1) {
+                successor_state = NODE_BOTTOM;
+                color = 1 - parity;
+                score = 0.0;
             }
-            */
-            successors.resize(local_state + 1);
-            /*
-            if (has_lock) {
-                successors_mutex.unlock();
-                has_lock = false;
+            else if (state == -2) {
+                successor_state = NODE_TOP;
+                color = parity;
+                score = 1.0;
             }
-            */
-        }
-
-        std::vector<int32_t>& tree = successors[local_state].tree;
-        std::vector<ScoredEdge>& leaves = successors[local_state].leaves;
-        if (leaves.empty()) {
-            automaton_edge_tree(owl, automaton,
-                    local_state,
-                    &owl_nodes, &owl_leaves, &owl_scores);
-
-            tree.reserve(owl_nodes.length);
-            tree.insert(tree.end(), owl_nodes.elements, owl_nodes.elements + owl_nodes.length);
-
-            leaves.reserve(owl_leaves.length);
-            for (int i = 0; i < owl_leaves.length; i += 2) {
-                node_id_t successor_state;
-                int32_t state = owl_leaves.elements [i];
-                int32_t color = owl_leaves.elements [i + 1];
-                double score = owl_scores.elements [i/2];
-                if (state == -1) {
-                    successor_state = NODE_BOTTOM;
-                    color = 1 - parity;
-                    score = 0.0;
-                }
-                else if (state == -2) {
-                    successor_state = NODE_TOP;
-                    color = parity;
-                    score = 1.0;
+            else {
+                successor_state = state;
+                if (node_type == NodeType::WEAK) {
+                    color = default_color;
                 }
                 else {
-                    successor_state = state;
-                    if (node_type == NodeType::WEAK) {
-                        color = default_color;
-                    }
-                    else {
-                        // shift score so values 0.0 and 1.0 are excluded
-                        score = 0.5*score + 0.25;
-                        if (node_type == NodeType::BUCHI || node_type == NodeType::CO_BUCHI) {
-                            if (color == -1) {
-                                color = 1;
-                            }
-                            else {
-                                color = 0;
-                            }
+                    // shift score so values 0.0 and 1.0 are excluded
+                    score = 0.5*score + 0.25;
+                    if (node_type == NodeType::BUCHI || node_type == NodeType::CO_BUCHI) {
+                        if (color == -1) {
+                            color = 1;
                         }
-                        else if (color == -1) {
-                            color = max_color;
+                        else {
+                            color = 0;
                         }
                     }
+                    else if (color == -1) {
+                        color = max_color;
+                    }
                 }
-                if (parity_type == ParityType::MAX) {
-                    color = max_color - color;
-                }
-                leaves.push_back(ScoredEdge(successor_state, color, score, 1.0));
             }
-
-            // free memory allocated by owl
-            free_unmanaged_memory(owl, owl_nodes.elements);
-            free_unmanaged_memory(owl, owl_leaves.elements);
-            free_unmanaged_memory(owl, owl_scores.elements);
-            owl_nodes.elements = nullptr;
-            owl_leaves.elements = nullptr;
-            owl_scores.elements = nullptr;
-
-            // flatten tree for small alphabets
-            if (alphabet_size <= 4) {
-                successors[local_state].flatten_tree(max_number_successors);
+            if (parity_type == ParityType::MAX) {
+                color = max_color - color;
             }
+            cache->leaves.push_back(ScoredEdge(successor_state, color, score, 1.0));
+        }
 
-            //new_successors.notify_all();
+        // free memory allocated by owl
+        free_unmanaged_memory(owl_thread, owl_nodes.elements);
+        free_unmanaged_memory(owl_thread, owl_leaves.elements);
+        free_unmanaged_memory(owl_thread, owl_scores.elements);
+        owl_nodes.elements = nullptr;
+        owl_leaves.elements = nullptr;
+        owl_scores.elements = nullptr;
+
+        // flatten tree for small alphabets
+        if (alphabet_size <= 4) {
+            cache->flatten_tree(max_number_successors);
         }
+
+        // publish the (now immutable) successors
+        entries[(size_t)local_state + 1 - ((size_t)1 << segment)].store(cache.get(), std::memory_order_release);
+        return cache.release();
     }
 
     ScoredEdge Automaton::getSuccessor(node_id_t local_state, letter_t letter) {
-        add_successors(local_state);
-        /*
-        std::unique_lock<std::mutex> lock(successors_mutex);
-        while(local_state >= successors.size() || successors[local_state].empty()) {
-            new_successors.wait(lock);
+        const SuccessorCache* cache = find_successors(local_state);
+        if (cache == nullptr) {
+            cache = add_successors(local_state);
         }
-        */
-        return successors[local_state].lookup(letter);
+        return cache->lookup(letter);
+    }
+
+    void Automaton::prepareSuccessors(node_id_t local_state) {
+        if (find_successors(local_state) == nullptr) {
+            add_successors(local_state);
+        }
+    }
+
+    void Automaton::prepareSuccessors(const std::vector<node_id_t>& local_states) {
+        std::lock_guard<std::mutex> lock(query_mutex);
+        for (node_id_t local_state : local_states) {
+            if (find_successors(local_state) == nullptr) {
+                query_successors(local_state, owl);
+            }
+        }
+    }
+
+    void Automaton::constructStates(JVM owl_thread) {
+        std::lock_guard<std::mutex> lock(query_mutex);
+        std::vector<node_id_t> to_explore = {0};
+        while (!to_explore.empty()) {
+            const node_id_t local_state = to_explore.back();
+            to_explore.pop_back();
+            if (find_successors(local_state) != nullptr) {
+                continue;
+            }
+            const SuccessorCache* cache = query_successors(local_state, owl_thread);
+            for (const ScoredEdge& edge : cache->leaves) {
+                if (edge.successor < NODE_NONE_TOP && find_successors(edge.successor) == nullptr) {
+                    to_explore.push_back(edge.successor);
+                }
+            }
+        }
+    }
+
+    Isolate Automaton::getIsolate() const {
+        return isolate;
     }
 
     bool Automaton::hasSafetyFilter() {
@@ -313,8 +333,11 @@ namespace strix_aut {
     }
 
     BDD Automaton::getSafetyFilter(Cudd manager, std::vector<int>& bdd_mapping) {
-        add_successors(0);
-        return successors[0].toBDD(manager, bdd_mapping);
+        const SuccessorCache* cache = find_successors(0);
+        if (cache == nullptr) {
+            cache = add_successors(0);
+        }
+        return cache->toBDD(manager, bdd_mapping);
     }
 
     void Automaton::print_type() const {
@@ -341,10 +364,19 @@ namespace strix_aut {
 
     void Automaton::print_memory_usage() const {
         size_t cache_size = 0;
-        for (const auto& succ : successors) {
-            cache_size += succ.tree.size() * sizeof(int32_t);
-            cache_size += succ.leaves.size() * sizeof(ScoredEdge);
-            cache_size += succ.direct.size() * sizeof(ScoredEdge);
+        for (size_t segment = 0; segment < N_SEGMENTS; segment++) {
+            const std::atomic<const SuccessorCache*>* entries = successors[segment].load(std::memory_order_acquire);
+            if (entries == nullptr) {
+                continue;
+            }
+            for (size_t i = 0; i < ((size_t)1 << segment); i++) {
+                const SuccessorCache* succ = entries[i].load(std::memory_order_acquire);
+                if (succ != nullptr) {
+                    cache_size += succ->tree.size() * sizeof(int32_t);
+                    cache_size += succ->leaves.size() * sizeof(ScoredEdge);
+                    cache_size += succ->direct.size() * sizeof(ScoredEdge);
+                }
+            }
         }
         std::cout << "Automaton successors: " << (cache_size / 1024) << std::endl;
     }
@@ -1140,10 +1172,9 @@ namespace strix_aut {
 
         OwlStructure owl_structure = decomposed_dpa_structure_get(owl, decomposed_automaton);
 
-        std::vector<ParityAutomatonTreeLeaf*> leaves;
-        structure.tree = structure.constructTree(owl_structure, leaves);
+        structure.tree = structure.constructTree(owl_structure, structure.leaves);
         structure.tree->getInitialState(structure.initial_state);
-        for (const ParityAutomatonTreeLeaf* leaf : leaves) {
+        for (const ParityAutomatonTreeLeaf* leaf : structure.leaves) {
             structure.leaf_state_indices.push_back(leaf->getStateIndex());
         }
 
@@ -1375,6 +1406,76 @@ namespace strix_aut {
         return tree->getSuccessor(state, new_state, letter);
     }
 
+    void AutomatonTreeStructure::prepareSuccessors(const product_state_t& state) {
+        for (ParityAutomatonTreeLeaf* leaf : leaves) {
+            const node_id_t local_state = state[leaf->getStateIndex()];
+            // skip the top/bottom/none markers
+            if (local_state < NODE_NONE_TOP) {
+                leaf->automaton.prepareSuccessors(local_state);
+            }
+        }
+    }
+
+    void AutomatonTreeStructure::prepareSuccessors(std::vector<product_state_t>::const_iterator first, std::vector<product_state_t>::const_iterator last) {
+        std::vector<node_id_t> local_states;
+        for (ParityAutomatonTreeLeaf* leaf : leaves) {
+            local_states.clear();
+            for (auto state = first; state != last; state++) {
+                const node_id_t local_state = (*state)[leaf->getStateIndex()];
+                if (local_state < NODE_NONE_TOP) {
+                    local_states.push_back(local_state);
+                }
+            }
+            leaf->automaton.prepareSuccessors(local_states);
+        }
+    }
+
+    void AutomatonTreeStructure::constructAutomata(size_t n_threads) {
+        n_threads = std::min(n_threads, automata.size());
+        if (n_threads <= 1) {
+            for (Automaton& automaton : automata) {
+                automaton.constructStates(owl);
+            }
+            return;
+        }
+
+        // the workers take the automata one by one. the first error is re-thrown after the join
+        std::atomic<size_t> next_automaton(0);
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        auto worker = [&]() {
+            JVM owl_thread = nullptr;
+            try {
+                if (graal_attach_thread(automata.front().getIsolate(), &owl_thread) != 0) {
+                    throw std::runtime_error("Could not attach a thread to GraalVM.");
+                }
+                for (size_t i = next_automaton++; i < automata.size(); i = next_automaton++) {
+                    automata[i].constructStates(owl_thread);
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            if (owl_thread != nullptr) {
+                graal_detach_thread(owl_thread);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < n_threads; t++) {
+            threads.emplace_back(worker);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
     BDD AutomatonTreeStructure::computeSafetyFilter(Cudd manager, size_t var_begin, size_t var_end) {
         return tree->computeSafetyFilter(manager, var_begin, var_end, 0);
     }
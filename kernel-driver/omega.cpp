@@ -6,6 +6,8 @@
  */
 #include "omega.h"
 
+#include <cstdio>
+
 namespace pFacesOmegaKernels{
 
 	/* a pointer to the only object */
@@ -134,7 +136,7 @@ namespace pFacesOmegaKernels{
 		if (config_dir.empty() || config_dir == std::string("")) {
 			config_dir = std::string(".") + std::string(PFACES_PATH_SPLITTER);
 		}
-		std::string code_file = config_dir + m_spCfg->readConfigValueString("system.dynamics.code_file");
+		code_file = config_dir + m_spCfg->readConfigValueString("system.dynamics.code_file");
 		if (!pfacesFileIO::isFileExist(code_file))
 			throw std::runtime_error(
 				std::string("The code file: ") + code_file +
@@ -146,6 +148,7 @@ namespace pFacesOmegaKernels{
 		init_discover_x_aps();
 		init_discover_u_aps();
 		init_construct_symmodel();
+		init_reach_symmodel();
 		init_construct_pgame();
 		init_solve_pgame();
 		init_implement();
@@ -161,7 +164,10 @@ namespace pFacesOmegaKernels{
 			funcs.push_back(func_info_discover_x_aps);
 		if(!dont_discover_u_aps)
 			funcs.push_back(func_info_discover_u_aps);		
-		funcs.push_back(func_info_construct_symmodel);	
+		if(!symmodel_cache_hit)
+			funcs.push_back(func_info_construct_symmodel);	
+		if(reach_waves > 0)
+			funcs.push_back(func_info_reach_symmodel);
 			
 
 		// create and add the functions
@@ -207,6 +213,9 @@ namespace pFacesOmegaKernels{
 		/* add instructions for the kernel function: discover_u_aps */
 		add_func_discover_u_aps(instrList, targetDevice);
 
+		/* add instructions for the kernel function: reach_symmodel */
+		add_func_reach_symmodel(instrList, targetDevice);
+
 		/* add instructions for the kernel function: construct_symmodel */
 		add_func_construct_symmodel(instrList, targetDevice);
 
@@ -232,6 +241,7 @@ namespace pFacesOmegaKernels{
 		init_mem_discover_x_aps();
 		init_mem_discover_u_aps();
 		init_mem_construct_symmodel();
+		init_mem_reach_symmodel();
 	}
 
 	/* the driver constructor */
@@ -259,6 +269,16 @@ namespace pFacesOmegaKernels{
 		updateParameters(param_names, param_values);
 	}
 
+	/* the driver destructor */
+	pFacesOmega::~pFacesOmega(){
+
+		// the posts file of a tiled construction is removed once it is unmapped (see stream_symmodel_tile)
+		if(pPostsFile){
+			pPostsFile.reset();
+			std::remove(posts_file.c_str());
+		}
+	}
+
 	/* provide the parallel program */
 	void pFacesOmega::configureParallelProgram(pfacesParallelProgram& parallelProgram){
 
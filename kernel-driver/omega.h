@@ -11,6 +11,8 @@
 #include "omegaImplementation.h"
 #include "omegaUtils.h"
 
+#include <cstring>
+
 // comment this to exclude the test functions
 //#define TEST_FUNCTION
 
@@ -27,6 +29,36 @@ namespace pFacesOmegaKernels {
     extern const std::vector<std::string> discover_u_aps_arg_names;
 	extern const std::string construct_symmodel_func_name;
 	extern const std::vector<std::string> construct_symmodel_arg_names;
+	extern const std::string reach_symmodel_func_name;
+	extern const std::vector<std::string> reach_symmodel_arg_names;
+
+	// the compact posts of an (x,u) (see omega_symmodel.cl): the flat index of the lower-left
+	// post (cl_uint), the extents per dimension (cl_uchar, cl_ushort or cl_uint: the smallest
+	// that holds the widths of the states) and the flags (cl_uchar)
+	const cl_uchar COMPACT_POSTS_OUT_OF_DOMAIN = 1;
+
+	// the extent of the dimension i of the compact posts pPosts
+	inline symbolic_t get_compact_posts_extent(const char* pPosts, const size_t i, const size_t extent_size){
+		const char* pExtent = pPosts + sizeof(cl_uint) + i*extent_size;
+		if(extent_size == sizeof(cl_uchar))
+			return *(const cl_uchar*)pExtent;
+		if(extent_size == sizeof(cl_ushort)){
+			cl_ushort extent;
+			std::memcpy(&extent, pExtent, sizeof(cl_ushort));
+			return extent;
+		}
+		cl_uint extent;
+		std::memcpy(&extent, pExtent, sizeof(cl_uint));
+		return extent;
+	}
+
+	// the marks of the state symbols in the reach set (see omega_symmodel.cl)
+	const cl_uchar REACH_UNREACHED = 0;
+	const cl_uchar REACH_REACHED = 1;
+
+	// the formats of the written symbolic model: the text lines of the (x,u) or a binary file
+	// to be mapped (see func_construct_symmodel.cpp)
+	enum class SymModelFileFormat {TEXT, BINARY};
 
 	// class: pFacesOmega, a 2d-kernel
 	class pFacesOmega : public pfaces2DKernel {
@@ -49,6 +81,7 @@ namespace pFacesOmegaKernels {
 		std::string kernel_path;
 		std::vector<std::string> param_names;
 		std::vector<std::string> param_values;
+		std::string code_file;
 		std::string extra_inc_dir;
 		size_t verbosity;
 		size_t x_dim;
@@ -102,14 +135,49 @@ namespace pFacesOmegaKernels {
 		
 		// some vars/funcs for: construct_symmodel (see func_construct_symmodel.cpp for implementation)
 		size_t size_struct_xu_posts;
+		bool compact_posts = false;
+		size_t compact_extent_size = sizeof(cl_uchar);
+		size_t symmodel_tile_x = 0;
+		size_t symmodel_tiles = 1;
+		size_t symmodel_tiles_streamed = 0;
+		std::string posts_file;
+		std::shared_ptr<MappedFile> pPostsFile;
+		const char* xu_posts_data = nullptr;
+		SymModelFileFormat symmodel_file_format = SymModelFileFormat::TEXT;
+		std::string symmodel_cache_file;
+		bool symmodel_cache_hit = false;
+		std::shared_ptr<MappedFile> pSymModelCacheFile;
 		std::vector<symbolic_t> initial_states;
 		func_info func_info_construct_symmodel;
 		void init_construct_symmodel();
 		void add_func_construct_symmodel(std::vector<std::shared_ptr<pfacesInstruction>>& instrList, const cl::Device& targetDevice);
 		void init_mem_construct_symmodel();	
+
+		// some vars/funcs for: reach_symmodel (see func_reach_symmodel.cpp for implementation)
+		size_t reach_waves = 0;
+		const cl_uchar* reach_states = nullptr;
+		func_info func_info_reach_symmodel;
+		void init_reach_symmodel();
+		void add_func_reach_symmodel(std::vector<std::shared_ptr<pfacesInstruction>>& instrList, const cl::Device& targetDevice);
+		void init_mem_reach_symmodel();
 		
 
 		// some vars/funcs for: construct_pgame (see func_construct_pgame.cpp for implementation)
+		std::string ltl_formula;
+		std::string dpa_file;
+		std::string save_dpa_file;
+		bool write_dpa = false;
+		bool realizable_letters_only = false;
+		DpaStorage dpa_storage = DpaStorage::TABLE;
+		DpaFileFormat dpa_file_format = DpaFileFormat::TEXT;
+		size_t dpa_construction_threads = 1;
+		bool minimize_dpa = false;
+		bool normalize_dpa_colors = false;
+		std::string dpa_cache_dir;
+		bool parallel_construction = false;
+		size_t construction_threads = 0;
+		bool posts_table = false;
+		bool pre_table = false;
 		void init_construct_pgame();
 		void add_func_construct_pgame(std::vector<std::shared_ptr<pfacesInstruction>>& instrList, const cl::Device& targetDevice);
 
@@ -126,7 +194,7 @@ namespace pFacesOmegaKernels {
 			const std::shared_ptr<pfacesKernelLaunchState>& spLaunchState, 
 			const std::shared_ptr<pfacesConfigurationReader>& spCfg
 		);
-		~pFacesOmega() = default;
+		~pFacesOmega();
 
 		void configureParallelProgram(
 			pfacesParallelProgram& parallelProgram);
@@ -8,6 +8,12 @@
 */
 
 #include "omegaControlProblem.h"
+#include "omegaUtils.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
 
 namespace pFacesOmegaKernels{
 
@@ -31,9 +37,46 @@ bool SymState::operator==(const SymState& anotherSymState) const {
 }
 
 
+// ------------------------------------------
+// class PostBox
+// ------------------------------------------
+symbolic_t PostBox::size() const {
+    symbolic_t n_posts = 1;
+    for (size_t i = 0; i < dim; i++)
+        n_posts *= counts[i];
+    return n_posts;
+}
+
+symbolic_t PostBox::ub_flat() const {
+    symbolic_t post_flat = lb_flat;
+    for (size_t i = 0; i < dim; i++)
+        post_flat += (counts[i] - 1)*strides[i];
+    return post_flat;
+}
+
+
 // ------------------------------------------
 // class SymModel
 // ------------------------------------------
+// the binary files of the tables of predecessors: a header, the offsets of the rows (uint64 per
+// state and one for the overflow state, plus the end) and the (x,u) pairs of the rows (symbolic_t
+// per pair). the numbers are stored in the byte order of the writing machine (checked by byte_order)
+static const char PRE_TABLE_FILE_MAGIC[8] = {'O', 'M', 'E', 'G', 'A', 'P', 'R', 'E'};
+static constexpr uint32_t PRE_TABLE_FILE_VERSION = 1;
+static constexpr uint32_t PRE_TABLE_FILE_BYTE_ORDER = 0x01020304;
+
+struct PreTableFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t symbolic_size;
+    uint64_t n_sym_states;
+    uint64_t n_sym_controls;
+    uint64_t n_pres;
+    uint64_t offsets_offset;
+    uint64_t pres_offset;
+};
+
 template<class F>
 SymModel<F>::SymModel(const size_t _n_sym_states, const size_t _n_sym_controls, const std::vector<symbolic_t>& sym_inital_states, F& post_func)
 :n_sym_states(_n_sym_states), n_sym_controls(_n_sym_controls), 
@@ -108,33 +151,277 @@ size_t SymModel<F>::get_n_controls(){
 template<class F>
 std::vector<SymState> SymModel<F>::get_posts(const SymState& state, const symbolic_t control) const {
 
-    static std::vector<SymState> ret_overflow = {overflow_state};
+    std::vector<SymState> ret;
+    for_each_post(state, control, [&](const SymState& post){
+        ret.push_back(post);
+    });
+    return ret;
+}
 
-    // is dummy ?
-    if(is_dummy_state(state))
-        throw std::runtime_error("SymModel::get_posts: no posts for DUMMY states.");
+template<class F>
+std::vector<symbolic_t> SymModel<F>::compute_posts(const symbolic_t state, const symbolic_t control) const {
 
-    // is overflow ?
-    if(is_overflow_state(state))
-        return ret_overflow;
+    PostBox posts_box;
+    get_sym_posts(state, control, posts_box);
+    if(posts_box.overflow || !is_valid_sym_state(posts_box.ub_flat()))
+        return {overflow_state.value};
 
-    // it is a normal state
-    if(is_valid_sym_state(state.value) && is_valid_sym_control(control)){
-        std::vector<symbolic_t> sym_post_states = get_sym_posts(state.value, control);
-        std::vector<SymState> ret;
-        
-        for (symbolic_t sym_state : sym_post_states){
+    std::vector<symbolic_t> ret;
+    ret.reserve(posts_box.size());
+    posts_box.for_each([&](const symbolic_t post_flat){
+        ret.push_back(post_flat);
+    });
+    return ret;
+}
 
-            if(!is_valid_sym_state(sym_state))
-                return ret_overflow;
+template<class F>
+void SymModel<F>::enable_posts_cache(const size_t n_threads){
+    posts_cache_enabled = true;
+    posts_cache_threads = (n_threads > 0 ? n_threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+}
 
-            ret.push_back(SymState(SymState::SYM_STATE_TYPE::NORMAL_STATE, sym_state));
-        }
+template<class F>
+bool SymModel<F>::is_posts_cache_enabled() const {
+    return posts_cache_enabled;
+}
+
+template<class F>
+void SymModel<F>::prepare_posts(const std::vector<std::pair<symbolic_t, symbolic_t>>& state_controls){
 
-        return ret;
+    if(!posts_cache_enabled || posts_table_built)
+        return;
+
+    // the pairs that are not cached yet (each once)
+    std::vector<size_t> missing;
+    for (const auto& state_control : state_controls){
+        if(!is_valid_sym_state(state_control.first) || !is_valid_sym_control(state_control.second))
+            continue;
+
+        const size_t xu_flat = state_control.first*n_sym_controls + state_control.second;
+        if(posts_cache_index.insert(std::make_pair(xu_flat, std::make_pair(0, 0))).second)
+            missing.push_back(xu_flat);
     }
-    else
-        throw std::runtime_error("SymModel::get_posts: Invalid input state or control.");
+
+    // compute their posts concurrently and append them to the cache
+    std::vector<std::vector<symbolic_t>> missing_posts(missing.size());
+    work_stealing_for(missing.size(), posts_cache_threads, 16, [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; i++)
+            missing_posts[i] = compute_posts(missing[i] / n_sym_controls, missing[i] % n_sym_controls);
+    });
+
+    for (size_t i = 0; i < missing.size(); i++){
+        const size_t begin = posts_cache.size();
+        posts_cache.insert(posts_cache.end(), missing_posts[i].begin(), missing_posts[i].end());
+        posts_cache_index[missing[i]] = std::make_pair(begin, posts_cache.size());
+    }
+}
+
+template<class F>
+size_t SymModel<F>::get_n_cached_posts() const {
+    return posts_cache_index.size();
+}
+
+template<class F>
+void SymModel<F>::build_posts_table(const size_t n_threads, const unsigned char* constructed_states){
+
+    const size_t n_table_threads = (n_threads > 0 ? n_threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+    const size_t n_sym_pairs = n_sym_states*n_sym_controls;
+    auto is_constructed = [&](const symbolic_t state){
+        return (constructed_states == nullptr || constructed_states[state] != 0);
+    };
+
+    // pass 1: the number of posts of each pair (one for an overflow), stored one row ahead
+    // so that the scan turns them into the offsets of the rows
+    posts_table_offsets.assign(n_sym_pairs + 1, 0);
+    work_stealing_for(n_sym_states, n_table_threads, 64, [&](size_t start, size_t end) {
+        for (size_t state = start; state < end; state++){
+            if(!is_constructed(state))
+                continue;
+            for (size_t control = 0; control < n_sym_controls; control++){
+                PostBox posts_box;
+                get_sym_posts(state, control, posts_box);
+                const bool overflow = (posts_box.overflow || !is_valid_sym_state(posts_box.ub_flat()));
+                posts_table_offsets[state*n_sym_controls + control + 1] = (overflow ? 1 : posts_box.size());
+            }
+        }
+    });
+
+    // pass 2: a prefix-scan of the counts
+    parallel_prefix_sum(posts_table_offsets.data() + 1, n_sym_pairs, n_table_threads);
+
+    // pass 3: the rows
+    posts_table.resize(posts_table_offsets[n_sym_pairs]);
+    work_stealing_for(n_sym_states, n_table_threads, 64, [&](size_t start, size_t end) {
+        for (size_t state = start; state < end; state++){
+            if(!is_constructed(state))
+                continue;
+            for (size_t control = 0; control < n_sym_controls; control++){
+                symbolic_t* row = posts_table.data() + posts_table_offsets[state*n_sym_controls + control];
+                PostBox posts_box;
+                get_sym_posts(state, control, posts_box);
+                if(posts_box.overflow || !is_valid_sym_state(posts_box.ub_flat())){
+                    *row = overflow_state.value;
+                    continue;
+                }
+                posts_box.for_each([&](const symbolic_t post_flat){
+                    *(row++) = post_flat;
+                });
+            }
+        }
+    });
+
+    posts_table_built = true;
+}
+
+template<class F>
+bool SymModel<F>::is_posts_table_built() const {
+    return posts_table_built;
+}
+
+template<class F>
+size_t SymModel<F>::get_n_table_posts() const {
+    return posts_table.size();
+}
+
+template<class F>
+void SymModel<F>::build_pre_table(const size_t n_threads, const unsigned char* constructed_states){
+
+    // the pairs are stored as flat (x,u) indices
+    if(n_sym_controls > 0 && n_sym_states > std::numeric_limits<symbolic_t>::max() / n_sym_controls)
+        throw std::runtime_error("SymModel::build_pre_table: too many (x,u) pairs for the flat indices of the table of predecessors.");
+
+    const size_t n_table_threads = (n_threads > 0 ? n_threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+    const size_t n_rows = n_sym_states + 1;
+    auto row_of = [&](const SymState& post){
+        return (is_overflow_state(post) ? n_sym_states : post.value);
+    };
+
+    // pass 1 (counting == true): the number of pairs per post in shared atomic counters, and
+    // pass 3 (counting == false): each pair takes the next free place in the rows of its posts
+    std::unique_ptr<std::atomic<size_t>[]> row_cursors(new std::atomic<size_t>[n_rows]);
+    auto place_pairs = [&](const bool counting){
+        work_stealing_for(n_sym_states, n_table_threads, 64, [&](size_t start, size_t end) {
+            for (size_t state = start; state < end; state++){
+                if(constructed_states != nullptr && constructed_states[state] == 0)
+                    continue;
+                const SymState sym_state(SymState::SYM_STATE_TYPE::NORMAL_STATE, state);
+                for (size_t control = 0; control < n_sym_controls; control++){
+                    const symbolic_t xu_flat = state*n_sym_controls + control;
+                    for_each_post(sym_state, control, [&](const SymState& post){
+                        const size_t place = row_cursors[row_of(post)].fetch_add(1, std::memory_order_relaxed);
+                        if(!counting)
+                            pre_table[place] = xu_flat;
+                    });
+                }
+            }
+        });
+    };
+
+    for (size_t row = 0; row < n_rows; row++)
+        row_cursors[row].store(0, std::memory_order_relaxed);
+    place_pairs(true);
+
+    // pass 2: a prefix-scan of the counts to the offsets of the rows
+    pre_table_offsets.assign(n_rows + 1, 0);
+    for (size_t row = 0; row < n_rows; row++)
+        pre_table_offsets[row + 1] = row_cursors[row].load(std::memory_order_relaxed);
+    parallel_prefix_sum(pre_table_offsets.data() + 1, n_rows, n_table_threads);
+
+    // pass 3: the cursors start at the offsets of the rows
+    for (size_t row = 0; row < n_rows; row++)
+        row_cursors[row].store(pre_table_offsets[row], std::memory_order_relaxed);
+    pre_table.resize(pre_table_offsets[n_rows]);
+    place_pairs(false);
+
+    // the order of the pairs within the rows does not depend on the threads
+    work_stealing_for(n_rows, n_table_threads, 1024, [&](size_t start, size_t end) {
+        for (size_t row = start; row < end; row++)
+            std::sort(pre_table.begin() + pre_table_offsets[row], pre_table.begin() + pre_table_offsets[row + 1]);
+    });
+
+    pre_table_built = true;
+}
+
+template<class F>
+void SymModel<F>::write_pre_table_file(const std::string& filename) const {
+
+    if(!pre_table_built)
+        throw std::runtime_error("SymModel::write_pre_table_file: the table of predecessors is not built.");
+
+    PreTableFileHeader header;
+    std::memset(&header, 0, sizeof(PreTableFileHeader));
+    std::memcpy(header.magic, PRE_TABLE_FILE_MAGIC, sizeof(PRE_TABLE_FILE_MAGIC));
+    header.version = PRE_TABLE_FILE_VERSION;
+    header.byte_order = PRE_TABLE_FILE_BYTE_ORDER;
+    header.symbolic_size = sizeof(symbolic_t);
+    header.n_sym_states = n_sym_states;
+    header.n_sym_controls = n_sym_controls;
+    header.n_pres = pre_table.size();
+    header.offsets_offset = sizeof(PreTableFileHeader);
+    header.pres_offset = header.offsets_offset + sizeof(uint64_t)*pre_table_offsets.size();
+
+    std::ofstream ofs(filename, std::ios::binary);
+    if(!ofs.good())
+        throw std::runtime_error("SymModel::write_pre_table_file: could not open the file " + filename + ".");
+
+    ofs.write((const char*)&header, sizeof(PreTableFileHeader));
+    std::vector<uint64_t> file_offsets(pre_table_offsets.begin(), pre_table_offsets.end());
+    ofs.write((const char*)file_offsets.data(), sizeof(uint64_t)*file_offsets.size());
+    ofs.write((const char*)pre_table.data(), sizeof(symbolic_t)*pre_table.size());
+
+    if(!ofs.good())
+        throw std::runtime_error("SymModel::write_pre_table_file: could not write the file " + filename + ".");
+}
+
+template<class F>
+void SymModel<F>::load_pre_table_file(const std::string& filename){
+
+    const std::string err_invalid_input = "SymModel::load_pre_table_file: invalid file " + filename + ": ";
+    MappedFile file(filename);
+    if(file.size() < sizeof(PreTableFileHeader))
+        throw std::runtime_error(err_invalid_input + "the file is too small.");
+
+    PreTableFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(PreTableFileHeader));
+    if(std::memcmp(header.magic, PRE_TABLE_FILE_MAGIC, sizeof(PRE_TABLE_FILE_MAGIC)) != 0 || header.version != PRE_TABLE_FILE_VERSION)
+        throw std::runtime_error(err_invalid_input + "not a table of predecessors of a supported version.");
+    if(header.byte_order != PRE_TABLE_FILE_BYTE_ORDER || header.symbolic_size != sizeof(symbolic_t))
+        throw std::runtime_error(err_invalid_input + "the file was written on a machine with another byte order or symbolic type.");
+    if(header.n_sym_states != n_sym_states || header.n_sym_controls != n_sym_controls)
+        throw std::runtime_error(err_invalid_input + "the table belongs to another symbolic model.");
+
+    const size_t n_offsets = n_sym_states + 2;
+    if(header.offsets_offset != sizeof(PreTableFileHeader) ||
+       header.pres_offset != header.offsets_offset + sizeof(uint64_t)*n_offsets ||
+       header.pres_offset + sizeof(symbolic_t)*header.n_pres != file.size())
+        throw std::runtime_error(err_invalid_input + "invalid sections of the file.");
+
+    const uint64_t* file_offsets = (const uint64_t*)(file.data() + header.offsets_offset);
+    if(file_offsets[0] != 0 || file_offsets[n_offsets - 1] != header.n_pres)
+        throw std::runtime_error(err_invalid_input + "invalid offsets of the rows.");
+    for (size_t row = 0; row < n_offsets - 1; row++)
+        if(file_offsets[row] > file_offsets[row + 1])
+            throw std::runtime_error(err_invalid_input + "invalid offsets of the rows.");
+
+    const symbolic_t* file_pres = (const symbolic_t*)(file.data() + header.pres_offset);
+    const uint64_t n_pairs = (uint64_t)n_sym_states * n_sym_controls;
+    for (size_t i = 0; i < header.n_pres; i++)
+        if(file_pres[i] >= n_pairs)
+            throw std::runtime_error(err_invalid_input + "a predecessor is not an (x,u) pair of the symbolic model.");
+
+    pre_table_offsets.assign(file_offsets, file_offsets + n_offsets);
+    pre_table.assign(file_pres, file_pres + header.n_pres);
+    pre_table_built = true;
+}
+
+template<class F>
+bool SymModel<F>::is_pre_table_built() const {
+    return pre_table_built;
+}
+
+template<class F>
+size_t SymModel<F>::get_n_table_pres() const {
+    return pre_table.size();
 }
 
 template<class F>
@@ -164,10 +451,9 @@ void SymModel<F>::print_info(){
 
     for(size_t x=0; x<n_sym_states; x++){
         for(size_t u=0; u<n_sym_controls; u++){
-            auto posts = get_sym_posts(x, u);
-            for(size_t xx_i=0; xx_i<posts.size(); xx_i++){
-                std::cout << "(" << x << "," << u << "," << posts[xx_i] << ") ";
-            }
+            for_each_post(construct_state(x), u, [&](const SymState& post){
+                std::cout << "(" << x << "," << u << "," << post.value << ") ";
+            });
         }
     }
     std::cout << std::endl;
@@ -226,10 +512,13 @@ SymSpec<L1, L2>::SymSpec(
         const std::vector<std::string>& _control_APs, 
         const std::string& _ltl_formula,
         L1& _L_x,
-        L2& _L_u):
+        L2& _L_u,
+        const DpaAlphabet& _dpa_alphabet,
+        const DpaStorage _dpa_storage,
+        const size_t _dpa_construction_threads):
     L_x(_L_x),
     L_u(_L_u),
-    dpa(TotalDPA(_state_APs, _control_APs, _ltl_formula)){
+    dpa(TotalDPA(_state_APs, _control_APs, _ltl_formula, false, _dpa_alphabet, _dpa_storage, _dpa_construction_threads)){
 
     // fill local data
     add_ltl_formula(_ltl_formula);
@@ -241,10 +530,12 @@ template<class L1, class L2>
 SymSpec<L1, L2>::SymSpec(
         const std::string& _dpa_file,
         L1& _L_x,
-        L2& _L_u):
+        L2& _L_u,
+        const DpaAlphabet& _dpa_alphabet,
+        const DpaStorage _dpa_storage):
     L_x(_L_x),
     L_u(_L_u),
-    dpa(TotalDPA(_dpa_file)){
+    dpa(TotalDPA(_dpa_file, _dpa_alphabet, _dpa_storage)){
 
     // fill local data
     add_ltl_formula(dpa.getLtlFormula());
@@ -319,25 +610,31 @@ strix_aut::letter_t SymSpec<L1, L2>::get_complete_clause(const SymState& symStat
     // bits  :                        ... 1 0           
     // vars  :    control_APs       state_APs     
 
-    // start with empty clause
-    strix_aut::letter_t clause = 0;
+    return get_state_clause(symState) | get_control_clause(control);
+}
+
+template<class L1, class L2>
+strix_aut::letter_t SymSpec<L1, L2>::get_state_clause(const SymState& symState) const {
 
     // add state APs having 'symState'
     if(symState.type == SymState::SYM_STATE_TYPE::NORMAL_STATE && count_state_APs() > 0){
         symbolic_t state = symState.value;
-        strix_aut::letter_t state_APs_clause = L_x(state);
-        clause = clause | state_APs_clause;
+        return L_x(state);
     }
 
+    return 0;
+}
+
+template<class L1, class L2>
+strix_aut::letter_t SymSpec<L1, L2>::get_control_clause(const symbolic_t control) const {
+
     // add control APs having 'control'
     if(count_control_APs() > 0){
         strix_aut::letter_t control_APs_clause = L_u(control);
-        control_APs_clause = control_APs_clause << count_state_APs();
-        clause = clause | control_APs_clause;
+        return control_APs_clause << count_state_APs();
     }
 
-
-    return clause;
+    return 0;
 }
 
 
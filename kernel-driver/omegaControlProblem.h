@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include <pfaces-sdk.h>
 #include <Ltl2Dpa.h>
@@ -20,8 +21,32 @@
 
 namespace pFacesOmegaKernels{
 
+// the posts of an (x,u) as a box of symbols in the X-space: the flat index of its lower-left
+// symbol, its number of symbols per dimension and the flat distance between two neighboring
+// symbols per dimension (the number of symbols in the lower dimensions). an overflow box is
+// a reach set that leaves the X-space. boxes live in the stack of their users, so the posts
+// are computed and visited by many threads without heap allocations
+class PostBox{
+public:
+    static const size_t MAX_DIM = 16;
+
+    bool overflow = false;
+    size_t dim = 0;
+    symbolic_t lb_flat = 0;
+    symbolic_t counts[MAX_DIM];
+    symbolic_t strides[MAX_DIM];
+
+    // the number of symbols in the box and the flat index of its upper-right symbol
+    symbolic_t size() const;
+    symbolic_t ub_flat() const;
+
+    // calls visit(post_flat) for all symbols in the box (the lowest dimension changes first)
+    template<class V>
+    void for_each(V&& visit) const;
+};
+
 // function types to by used for tempated classes
-typedef std::vector<symbolic_t> (post_func_t)(symbolic_t, symbolic_t);
+typedef void (post_func_t)(symbolic_t, symbolic_t, PostBox&);
 typedef symbolic_t (L_x_func_t)(symbolic_t);
 typedef symbolic_t (L_u_func_t)(symbolic_t);
 
@@ -52,7 +77,7 @@ public:
 // a class to represent the symbolic model
 // F: the type of the function used for posts on the template:
 //
-//      std::vector<symbolic_t> posts(symbolic_t x, symbolic_t u);
+//      void posts(symbolic_t x, symbolic_t u, PostBox& posts_box);
 //
 // you may change the template in top of this header.
 //
@@ -74,6 +99,34 @@ class SymModel {
 
     // the set of initial states
     std::vector<SymState> initial_states;    
+
+    // a cache of the posts of the (x,u) pairs demanded by the game so far (see prepare_posts): the
+    // posts of a pair are posts_cache[begin, end) with (begin, end) = posts_cache_index[x*n_sym_controls + u]
+    bool posts_cache_enabled = false;
+    size_t posts_cache_threads = 1;
+    std::unordered_map<size_t, std::pair<size_t, size_t>> posts_cache_index;
+    std::vector<symbolic_t> posts_cache;
+
+    // a table of the posts of all the (x,u) pairs (see build_posts_table): the posts of a pair are
+    // posts_table[posts_table_offsets[xu], posts_table_offsets[xu+1]) with xu = x*n_sym_controls + u
+    bool posts_table_built = false;
+    std::vector<size_t> posts_table_offsets;
+    std::vector<symbolic_t> posts_table;
+
+    // a table of the predecessors of the states (see build_pre_table): the (x,u) pairs having the state
+    // x' as a post are pre_table[pre_table_offsets[x'], pre_table_offsets[x'+1]) as x*n_sym_controls + u.
+    // the last row is the one of the overflow state
+    bool pre_table_built = false;
+    std::vector<size_t> pre_table_offsets;
+    std::vector<symbolic_t> pre_table;
+
+    // visits the stored posts [first, last) of the cache or the table
+    template<class V>
+    void visit_stored_posts(const symbolic_t* first, const symbolic_t* last, V&& visit) const;
+
+    // the posts of a normal state from the post function (the value of the overflow state if the
+    // posts leave the X-space)
+    std::vector<symbolic_t> compute_posts(const symbolic_t state, const symbolic_t control) const;
  
 public:
 
@@ -94,6 +147,43 @@ public:
     size_t get_n_controls();
     std::vector<SymState> get_posts(const SymState& state, const symbolic_t control) const;
 
+    // calls visit(const SymState& post) for all the posts of (state, control) without allocating
+    // them (the overflow state alone if they leave the X-space). safe to call concurrently
+    template<class V>
+    void for_each_post(const SymState& state, const symbolic_t control, V&& visit) const;
+
+    // the posts on demand: once enabled, the posts of the (x,u) pairs passed to prepare_posts (e.g., the
+    // ones of an exploration wave of the game) are computed together by many threads (zero for all the
+    // hardware threads) and cached. get_posts then reads the cached posts (concurrently)
+    void enable_posts_cache(const size_t n_threads = 1);
+    bool is_posts_cache_enabled() const;
+    void prepare_posts(const std::vector<std::pair<symbolic_t, symbolic_t>>& state_controls);
+    size_t get_n_cached_posts() const;
+
+    // the posts of all the (x,u) pairs at once: many threads (zero for all the hardware threads) count
+    // the posts of each pair, prefix-scan the counts to the offsets of the rows of a table and fill the
+    // rows. the states marked zero in constructed_states (if given, e.g., the ones out of the reach set)
+    // get empty rows. for_each_post then reads the rows directly (concurrently)
+    void build_posts_table(const size_t n_threads = 1, const unsigned char* constructed_states = nullptr);
+    bool is_posts_table_built() const;
+    size_t get_n_table_posts() const;
+
+    // the predecessors of all the states at once, by a counting sort of the posts of all the (x,u) pairs
+    // done by many threads (zero for all the hardware threads): the pairs are counted per post, the counts
+    // are prefix-scanned to the offsets of the rows of a table and the pairs are placed in the rows (each
+    // row is then sorted). the states marked zero in constructed_states (as in build_posts_table) have no
+    // posts. the table can be written to and loaded from a binary file
+    void build_pre_table(const size_t n_threads = 1, const unsigned char* constructed_states = nullptr);
+    void write_pre_table_file(const std::string& filename) const;
+    void load_pre_table_file(const std::string& filename);
+    bool is_pre_table_built() const;
+    size_t get_n_table_pres() const;
+
+    // calls visit(const SymState& pre, const symbolic_t control) for all the (x,u) pairs having the
+    // state as a post (the overflow state for the pairs that leave the X-space). safe to call concurrently
+    template<class V>
+    void for_each_pre(const SymState& state, V&& visit) const;
+
     // constructs a state in a smart way using only its symbolic value
     // if value < num_state => normal
     // if value = num_state => dummy
@@ -104,6 +194,104 @@ public:
     void print_info();
 };
 
+template<class V>
+void PostBox::for_each(V&& visit) const {
+
+    // a counter per dimension (the box lives in the stack of its user)
+    symbolic_t postcell[MAX_DIM] = {0};
+    symbolic_t post_flat = lb_flat;
+    const symbolic_t n_posts = size();
+    for (symbolic_t p = 0; p < n_posts; p++){
+        visit(post_flat);
+
+        // the next post: reset the full dimensions and step in the first non-full one
+        for (size_t i = 0; i < dim; i++){
+            postcell[i]++;
+            post_flat += strides[i];
+            if(postcell[i] < counts[i])
+                break;
+            post_flat -= postcell[i]*strides[i];
+            postcell[i] = 0;
+        }
+    }
+}
+
+template<class F>
+template<class V>
+void SymModel<F>::visit_stored_posts(const symbolic_t* first, const symbolic_t* last, V&& visit) const {
+    for (const symbolic_t* post = first; post != last; post++){
+        if(*post == overflow_state.value)
+            visit(overflow_state);
+        else
+            visit(SymState(SymState::SYM_STATE_TYPE::NORMAL_STATE, *post));
+    }
+}
+
+template<class F>
+template<class V>
+void SymModel<F>::for_each_post(const SymState& state, const symbolic_t control, V&& visit) const {
+
+    // is dummy ?
+    if(is_dummy_state(state))
+        throw std::runtime_error("SymModel::for_each_post: no posts for DUMMY states.");
+
+    // is overflow ?
+    if(is_overflow_state(state)){
+        visit(overflow_state);
+        return;
+    }
+
+    // it is a normal state
+    if(!is_valid_sym_state(state.value) || !is_valid_sym_control(control))
+        throw std::runtime_error("SymModel::for_each_post: Invalid input state or control.");
+
+    // the table of posts
+    if(posts_table_built){
+        const size_t xu_flat = state.value*n_sym_controls + control;
+        visit_stored_posts(
+            posts_table.data() + posts_table_offsets[xu_flat], posts_table.data() + posts_table_offsets[xu_flat + 1], visit);
+        return;
+    }
+
+    // the cached posts
+    if(posts_cache_enabled){
+        auto found = posts_cache_index.find(state.value*n_sym_controls + control);
+        if(found != posts_cache_index.end()){
+            visit_stored_posts(
+                posts_cache.data() + found->second.first, posts_cache.data() + found->second.second, visit);
+            return;
+        }
+    }
+
+    PostBox posts_box;
+    get_sym_posts(state.value, control, posts_box);
+    if(posts_box.overflow || !is_valid_sym_state(posts_box.ub_flat())){
+        visit(overflow_state);
+        return;
+    }
+    posts_box.for_each([&](const symbolic_t post_flat){
+        visit(SymState(SymState::SYM_STATE_TYPE::NORMAL_STATE, post_flat));
+    });
+}
+
+
+template<class F>
+template<class V>
+void SymModel<F>::for_each_pre(const SymState& state, V&& visit) const {
+
+    if(!pre_table_built)
+        throw std::runtime_error("SymModel::for_each_pre: the table of predecessors is not built.");
+
+    if(is_dummy_state(state))
+        throw std::runtime_error("SymModel::for_each_pre: no predecessors for DUMMY states.");
+
+    const size_t row = (is_overflow_state(state) ? n_sym_states : state.value);
+    if(row > n_sym_states)
+        throw std::runtime_error("SymModel::for_each_pre: Invalid input state.");
+
+    for (size_t i = pre_table_offsets[row]; i < pre_table_offsets[row + 1]; i++)
+        visit(SymState(SymState::SYM_STATE_TYPE::NORMAL_STATE, pre_table[i] / n_sym_controls), pre_table[i] % n_sym_controls);
+}
 
 // a class to represent the symbolic specifications
 // L1: the type of the function used to map X -> X_APs (i.e., L_x)
@@ -154,17 +342,24 @@ public:
     // a total DPA to represent the low-level spec
     TotalDPA dpa;
 
-    // constructors
+    // constructors (the DPA can be restricted to an alphabet, e.g., the realizable letters only, and
+    // its transitions can be stored as tables or decision trees). a DPA from an LTL formula can be
+    // explored by many threads
     SymSpec(
         const std::vector<std::string>& _state_APs, 
         const std::vector<std::string>& _control_APs, 
         const std::string& _ltl_formula,
         L1& _L_x,
-        L2& _L_u);
+        L2& _L_u,
+        const DpaAlphabet& _dpa_alphabet = DpaAlphabet(),
+        const DpaStorage _dpa_storage = DpaStorage::TABLE,
+        const size_t _dpa_construction_threads = 1);
     SymSpec(
         const std::string& _dpa_file,
         L1& _L_x,
-        L2& _L_u);
+        L2& _L_u,
+        const DpaAlphabet& _dpa_alphabet = DpaAlphabet(),
+        const DpaStorage _dpa_storage = DpaStorage::TABLE);
 
     // is a specific AP valid 
     bool is_valid_AP(std::string AP);
@@ -183,6 +378,11 @@ public:
     // from a state and control, get a complete clause in AP space
     strix_aut::letter_t get_complete_clause(const SymState& symState, const symbolic_t control) const;
 
+    // the parts of the complete clause coming from the state APs and the control APs
+    // (i.e., get_complete_clause(x, u) == get_state_clause(x) | get_control_clause(u))
+    strix_aut::letter_t get_state_clause(const SymState& symState) const;
+    strix_aut::letter_t get_control_clause(const symbolic_t control) const;
+
     // print info
     void print_info();
 };
@@ -12,6 +12,11 @@
 #include "omegaUtils.h"
 
 #include <bitset>
+#include <cstring>
+#include <thread>
+#include <set>
+#include <algorithm>
+#include <unordered_map>
 
 namespace pFacesOmegaKernels{
 
@@ -59,9 +64,76 @@ TotalDpaEdge TotalDpaEdge::parse(const std::string& str, const std::vector<strix
 
 
 
+// ------------------------------------------
+// struct LazyDpa
+// ------------------------------------------
+LazyDpa::LazyDpa(const size_t _row_size) : row_size(_row_size), n_states(0) {
+    for(size_t s = 0; s < N_SEGMENTS; s++)
+        segments[s].store(nullptr);
+}
+
+LazyDpa::~LazyDpa(){
+    for(size_t s = 0; s < N_SEGMENTS; s++)
+        delete[] segments[s].load();
+}
+
+
+
 // ------------------------------------------
 // class TotalDPA
 // ------------------------------------------
+// the definition of the marker of the letters out of the alphabet (it is passed by reference)
+constexpr uint32_t TotalDPA::NO_SLOT;
+
+// the number of (state, letter) pairs in a batch of the exploration in the LTL constructor
+// and a marker for the successors that are not found (yet) while exploring a batch
+static constexpr size_t EXPLORATION_BATCH = 16384;
+static constexpr size_t NO_STATE = std::numeric_limits<size_t>::max();
+
+// the version of the cached DPAs: bump it when the construction of the DPAs or their file format
+// changes so the DPAs cached by older versions are not used anymore
+static const std::string DPA_CACHE_VERSION = "omega-dpa-1";
+
+// the binary DPA files: a header followed by the sections at the offsets given in the header. the
+// sections start at 64-byte boundaries so the table of a mapped file starts at a cache-line boundary.
+// the numbers are stored in the byte order of the writing machine (checked by byte_order). the
+// sections are: the in/out var names (each ending with a zero byte), the LTL formula, the statuses
+// (int32 per var), the in/out letters (uint64), the product states (uint32 per entry), the state
+// flags (uint8 per state), the transition table (a DpaTransition per state and letter slot) and the
+// scores of the transitions (a double per state and letter slot)
+static const char DPA_FILE_MAGIC[8] = {'O', 'M', 'E', 'G', 'A', 'D', 'P', 'A'};
+static constexpr uint32_t DPA_FILE_VERSION = 1;
+static constexpr uint32_t DPA_FILE_BYTE_ORDER = 0x01020304;
+static constexpr uint64_t DPA_FILE_ALIGNMENT = 64;
+
+struct DpaFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t n_in_vars;
+    uint64_t n_out_vars;
+    uint64_t product_state_size;
+    uint64_t n_states;
+    uint64_t n_in_letters;
+    uint64_t n_out_letters;
+    uint32_t parity;
+    uint32_t max_color;
+    uint32_t simplified_ltl;
+    uint32_t reserved;
+    uint64_t vars_offset;
+    uint64_t vars_size;
+    uint64_t ltl_formula_offset;
+    uint64_t ltl_formula_size;
+    uint64_t statuses_offset;
+    uint64_t letters_offset;
+    uint64_t states_offset;
+    uint64_t flags_offset;
+    uint64_t table_offset;
+    uint64_t scores_offset;
+    uint64_t file_size;
+};
+static_assert(sizeof(DpaTransition) == 8, "DpaTransition must be packed in 8 bytes for the binary DPA files.");
+
 inline std::pair<bool, size_t> TotalDPA::is_state_in_states(const strix_aut::product_state_t& state){
 
     if(!dpa_state_idx_map_ready){
@@ -86,12 +158,10 @@ inline std::pair<bool, size_t> TotalDPA::is_state_in_states(const strix_aut::pro
 
     }else{
 
-        try{
-            return std::make_pair(true, dpa_state_idx_map.at(state));
-        }
-        catch(...){
+        auto found = dpa_state_idx_map.find(state);
+        if(found == dpa_state_idx_map.end())
             return std::make_pair(false, 0);
-        }
+        return std::make_pair(true, found->second);
     }
 }
 
@@ -104,12 +174,283 @@ void TotalDPA::cache_states(){
     dpa_state_idx_map_ready = true;
 }
 
-TotalDPA::TotalDPA(const std::string& filename){
-    loadFromFile(filename);
+// the relevant letters (masked by the relevant bits) of a list of letters (all letters if empty) and
+// the slots of the letters in the list (the slot of its relevant letter)
+static void reduce_letters(
+    const std::vector<strix_aut::letter_t>& letters_list, const size_t n_vars, const strix_aut::letter_t relevant_bits, 
+    std::vector<strix_aut::letter_t>& relevant_letters, std::vector<uint32_t>& letter_slots, const uint32_t no_slot){
+
+    std::vector<strix_aut::letter_t> letters = letters_list;
+    if(letters.empty())
+        for(strix_aut::letter_t l = 0; l < ((strix_aut::letter_t)1 << n_vars); l++)
+            letters.push_back(l);
+
+    relevant_letters.clear();
+    for(const strix_aut::letter_t l : letters){
+        if(l >= ((strix_aut::letter_t)1 << n_vars))
+            throw std::runtime_error("TotalDPA::init_alphabet: invalid letter " + std::to_string(l) + ".");
+        relevant_letters.push_back(l & relevant_bits);
+    }
+    std::sort(relevant_letters.begin(), relevant_letters.end());
+    relevant_letters.erase(std::unique(relevant_letters.begin(), relevant_letters.end()), relevant_letters.end());
+
+    letter_slots.assign((size_t)1 << n_vars, no_slot);
+    for(const strix_aut::letter_t l : letters)
+        letter_slots[l] = (uint32_t)(std::lower_bound(relevant_letters.begin(), relevant_letters.end(), l & relevant_bits) - relevant_letters.begin());
+}
+
+strix_aut::letter_t TotalDPA::relevant_bits(const size_t first_var, const size_t n_vars) const {
+    strix_aut::letter_t bits = 0;
+    for(size_t i = 0; i < n_vars; i++)
+        if(first_var + i >= statuses.size() || statuses[first_var + i] == USED)
+            bits |= ((strix_aut::letter_t)1 << i);
+    return bits;
+}
+
+void TotalDPA::init_alphabet(const DpaAlphabet& alphabet){
+
+    const size_t n_in_vars = inVars.size();
+    const size_t n_out_vars = outVars.size();
+    if(n_in_vars >= 32 || n_out_vars >= 32)
+        throw std::runtime_error("TotalDPA::init_alphabet: too many IO vars.");
+
+    // only the USED vars affect the transitions: the letters agreeing on them share a slot
+    reduce_letters(alphabet.in_letters, n_in_vars, relevant_bits(0, n_in_vars), in_letters, in_letter_slots, NO_SLOT);
+    reduce_letters(alphabet.out_letters, n_out_vars, relevant_bits(n_in_vars, n_out_vars), out_letters, out_letter_slots, NO_SLOT);
+
+    n_possible_letters = in_letters.size()*out_letters.size();
+}
+
+size_t TotalDPA::getLetterSlot(const strix_aut::letter_t& io_letter) const {
+    const strix_aut::letter_t in_letter = io_letter & (((strix_aut::letter_t)1 << inVars.size()) - 1);
+    const strix_aut::letter_t out_letter = io_letter >> inVars.size();
+
+    if(out_letter >= out_letter_slots.size() || in_letter_slots[in_letter] == NO_SLOT || out_letter_slots[out_letter] == NO_SLOT)
+        throw std::runtime_error("TotalDPA::getLetterSlot: the letter " + std::to_string(io_letter) + " is not in the alphabet of the DPA.");
+
+    return in_letter_slots[in_letter] + out_letter_slots[out_letter]*in_letters.size();
+}
+
+bool TotalDPA::hasCompleteAlphabet() const {
+    return 
+        std::find(in_letter_slots.begin(), in_letter_slots.end(), NO_SLOT) == in_letter_slots.end() &&
+        std::find(out_letter_slots.begin(), out_letter_slots.end(), NO_SLOT) == out_letter_slots.end();
+}
+
+int32_t TotalDPA::build_tree(const std::vector<TotalDpaEdge>& edges, std::vector<size_t>& slots, const size_t begin, const size_t end, const size_t first_leaf){
+
+    // all the letters have the same edge: a leaf (shared with the same leaves of the state)
+    const TotalDpaEdge& first = edges[slots[begin]];
+    strix_aut::letter_t differing_bits = 0;
+    bool same_edges = true;
+    for(size_t k = begin; k < end; k++){
+        const TotalDpaEdge& edge = edges[slots[k]];
+        differing_bits |= edge.letter ^ first.letter;
+        same_edges = same_edges && 
+            edge.successor_idx == first.successor_idx && edge.cs.color == first.cs.color && 
+            edge.cs.score == first.cs.score && edge.cs.weight == first.cs.weight;
+    }
+    if(same_edges){
+        for(size_t leaf = first_leaf; leaf < tree_leaves.size(); leaf++){
+            if(tree_leaves[leaf].successor_idx == first.successor_idx && tree_leaf_cs[leaf].color == first.cs.color && 
+               tree_leaf_cs[leaf].score == first.cs.score && tree_leaf_cs[leaf].weight == first.cs.weight)
+                return -(int32_t)leaf - 1;
+        }
+        tree_leaves.push_back(DpaTransition({(uint32_t)first.successor_idx, first.cs.color}));
+        tree_leaf_cs.push_back(first.cs);
+        return -(int32_t)(tree_leaves.size() - 1) - 1;
+    }
+
+    // otherwise, split the letters by the lowest bit they differ in
+    int32_t bit = 0;
+    while((differing_bits & ((strix_aut::letter_t)1 << bit)) == 0)
+        bit++;
+    const size_t mid = (size_t)(std::stable_partition(slots.begin() + begin, slots.begin() + end, 
+        [&](const size_t slot){ return (edges[slot].letter & ((strix_aut::letter_t)1 << bit)) == 0; }) - slots.begin());
+
+    const int32_t node = (int32_t)tree_nodes.size();
+    tree_nodes.insert(tree_nodes.end(), {bit, 0, 0});
+    const int32_t false_child = build_tree(edges, slots, begin, mid, first_leaf);
+    const int32_t true_child = build_tree(edges, slots, mid, end, first_leaf);
+    tree_nodes[node + 1] = false_child;
+    tree_nodes[node + 2] = true_child;
+    return node;
+}
+
+void TotalDPA::compress_state_edges(const size_t state_idx){
+
+    if(storage != DpaStorage::DECISION_TREE)
+        return;
+
+    std::vector<TotalDpaEdge>& edges = state_edges[state_idx];
+    if(edges.size() != n_possible_letters || n_possible_letters == 0)
+        throw std::runtime_error("TotalDPA::compress_state_edges: the state " + std::to_string(state_idx) + " does not have an edge for each letter.");
+    for(size_t slot = 0; slot < n_possible_letters; slot++)
+        if(edges[slot].letter != slot_letter(slot))
+            throw std::runtime_error("TotalDPA::compress_state_edges: the edges of state " + std::to_string(state_idx) + " are not ordered by the letters.");
+    if(tree_nodes.size() + 3*n_possible_letters >= (size_t)std::numeric_limits<int32_t>::max())
+        throw std::runtime_error("TotalDPA::compress_state_edges: too many nodes for the decision trees.");
+
+    std::vector<size_t> slots(n_possible_letters);
+    for(size_t slot = 0; slot < n_possible_letters; slot++)
+        slots[slot] = slot;
+
+    if(tree_roots.size() <= state_idx)
+        tree_roots.resize(state_idx + 1, -1);
+    tree_roots[state_idx] = build_tree(edges, slots, 0, n_possible_letters, tree_leaves.size());
+
+    // the edges are not needed anymore
+    std::vector<TotalDpaEdge>().swap(edges);
+}
+
+TotalDpaEdge TotalDPA::get_edge(const size_t state_idx, const size_t slot) const {
+
+    if(storage == DpaStorage::LAZY){
+        const DpaTransition transition = getTransition(state_idx, slot);
+
+        // the score is not memoized: ask the structure again (it caches its successors)
+        std::lock_guard<std::mutex> lock(lazy->mutex);
+        strix_aut::product_state_t successor(product_state_size);
+        const strix_aut::ColorScore cs = lazy->structure->getSuccessor(lazy->states[state_idx], successor, slot_letter(slot));
+        return TotalDpaEdge(slot_letter(slot), successor, cs, transition.successor_idx);
+    }
+
+    if(storage == DpaStorage::DECISION_TREE){
+        const size_t leaf = tree_leaf(state_idx, slot_letter(slot));
+        const size_t successor_idx = tree_leaves[leaf].successor_idx;
+        return TotalDpaEdge(slot_letter(slot), states[successor_idx], tree_leaf_cs[leaf], successor_idx);
+    }
+
+    // a table from a mapped file (without edges)
+    if(transition_scores != nullptr){
+        const DpaTransition& transition = transition_table[state_idx*n_possible_letters + slot];
+        const strix_aut::ColorScore cs(transition.color, transition_scores[state_idx*n_possible_letters + slot], 1.0);
+        return TotalDpaEdge(slot_letter(slot), states[transition.successor_idx], cs, transition.successor_idx);
+    }
+
+    return state_edges[state_idx][slot];
+}
+
+size_t TotalDPA::lazy_add_state(const strix_aut::product_state_t& state) const {
+
+    // the lazy mutex must be held by the caller
+    auto found = lazy->state_idx_map.find(state);
+    if(found != lazy->state_idx_map.end())
+        return found->second;
+
+    const size_t state_idx = lazy->states.size();
+    if(state_idx >= std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("TotalDPA::lazy_add_state: too many states for the lazy DPA.");
+
+    // the row of the new state (in a new segment if needed) with the flags after the letters
+    const size_t segment = LazyDpa::segment_of(state_idx);
+    if(lazy->segments[segment].load(std::memory_order_relaxed) == nullptr)
+        lazy->segments[segment].store(new std::atomic<uint64_t>[((size_t)1 << segment)*lazy->row_size](), std::memory_order_release);
+
+    const bool is_top = lazy->structure->isTopState(state);
+    const bool is_bottom = lazy->structure->isBottomState(state);
+    lazy->row(state_idx)[n_possible_letters].store((is_top ? STATE_FLAG_TOP : 0) | (is_bottom ? STATE_FLAG_BOTTOM : 0), std::memory_order_relaxed);
+
+    lazy->states.push_back(state);
+    lazy->states_is_top.push_back(is_top);
+    lazy->states_is_bottom.push_back(is_bottom);
+    lazy->state_idx_map.insert(std::make_pair(state, state_idx));
+    lazy->n_states.store(state_idx + 1, std::memory_order_release);
+    return state_idx;
+}
+
+DpaTransition TotalDPA::compute_lazy_transition(const symbolic_t state_idx, const size_t letter_slot) const {
+
+    std::lock_guard<std::mutex> lock(lazy->mutex);
+
+    // another caller may have computed it meanwhile
+    std::atomic<uint64_t>& entry = lazy->row(state_idx)[letter_slot];
+    uint64_t value = entry.load(std::memory_order_relaxed);
+    if(value == 0){
+        strix_aut::product_state_t successor(product_state_size);
+        const strix_aut::ColorScore cs = lazy->structure->getSuccessor(lazy->states[state_idx], successor, slot_letter(letter_slot));
+        if(cs.color >= ((strix_aut::color_t)1 << 31))
+            throw std::runtime_error("TotalDPA::compute_lazy_transition: the color is too large for the lazy DPA.");
+
+        const size_t successor_idx = lazy_add_state(successor);
+        value = LazyDpa::VALID | ((uint64_t)cs.color << 32) | (uint64_t)successor_idx;
+
+        // publish it (after the row of the successor)
+        entry.store(value, std::memory_order_release);
+    }
+
+    return DpaTransition({(uint32_t)value, (strix_aut::color_t)((value & ~LazyDpa::VALID) >> 32)});
+}
+
+void TotalDPA::explore_all(){
+
+    if(storage != DpaStorage::LAZY)
+        return;
+
+    // compute all transitions of all (new) states
+    for(size_t state_idx = 0; state_idx < getStatesCount(); state_idx++)
+        for(size_t slot = 0; slot < n_possible_letters; slot++)
+            getTransition(state_idx, slot);
+
+    std::lock_guard<std::mutex> lock(lazy->mutex);
+    states = lazy->states;
+    states_is_top = lazy->states_is_top;
+    states_is_bottom = lazy->states_is_bottom;
+}
+
+void TotalDPA::build_transition_table(){
+
+    if(states.size() > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("TotalDPA::build_transition_table: too many states for the transition table.");
+
+    state_flags.resize(states.size());
+    for(size_t state_idx = 0; state_idx < states.size(); state_idx++){
+        state_flags[state_idx] = 
+            (states_is_top[state_idx] ? STATE_FLAG_TOP : 0) | 
+            (states_is_bottom[state_idx] ? STATE_FLAG_BOTTOM : 0);
+    }
+
+    // the transitions are in the decision trees (or the lazy rows, or a mapped file)
+    if(storage != DpaStorage::TABLE || transition_table != nullptr)
+        return;
+
+    // allocate one more cache line to be able to start the table at a cache-line boundary
+    const size_t cache_line = 64;
+    const size_t line_entries = cache_line / sizeof(DpaTransition);
+    std::shared_ptr<std::vector<DpaTransition>> table = 
+        std::make_shared<std::vector<DpaTransition>>(states.size()*n_possible_letters + line_entries, DpaTransition({0, 0}));
+    const size_t misalignment = (size_t)((uintptr_t)table->data() % cache_line) / sizeof(DpaTransition);
+    DpaTransition* rows = table->data() + (misalignment == 0 ? 0 : line_entries - misalignment);
+
+    for(size_t state_idx = 0; state_idx < states.size(); state_idx++){
+        if(state_edges[state_idx].size() != n_possible_letters)
+            throw std::runtime_error("TotalDPA::build_transition_table: the state " + std::to_string(state_idx) + " does not have an edge for each letter.");
+
+        DpaTransition* row = rows + state_idx*n_possible_letters;
+        for(size_t slot = 0; slot < n_possible_letters; slot++){
+            const TotalDpaEdge& edge = state_edges[state_idx][slot];
+            if(edge.letter != slot_letter(slot))
+                throw std::runtime_error("TotalDPA::build_transition_table: the edges of state " + std::to_string(state_idx) + " are not ordered by the letters.");
+
+            row[slot].successor_idx = (uint32_t)edge.successor_idx;
+            row[slot].color = edge.cs.color;
+        }
+    }
+    transition_table = rows;
+    transition_table_owner = table;
+}
+
+TotalDPA::TotalDPA(const std::string& filename, const DpaAlphabet& alphabet, const DpaStorage _storage){
+    storage = _storage;
+    if(storage == DpaStorage::LAZY)
+        throw std::runtime_error("TotalDPA::TotalDPA: a DPA loaded from a file can not be lazy.");
+
+    loadFromFile(filename, alphabet);
     cache_states();
+    build_transition_table();
 }
 
-TotalDPA::TotalDPA(const std::vector<std::string>& _inVars, const std::vector<std::string>& _outVars, const std::string& _ltl_formula, bool simplify_spec){
+TotalDPA::TotalDPA(const std::vector<std::string>& _inVars, const std::vector<std::string>& _outVars, const std::string& _ltl_formula, bool simplify_spec, const DpaAlphabet& alphabet, const DpaStorage _storage, const size_t construction_threads){
 
     // store locally
     inVars = _inVars;
@@ -117,10 +458,13 @@ TotalDPA::TotalDPA(const std::vector<std::string>& _inVars, const std::vector<st
     ltl_formula = _ltl_formula;
     n_io_vars = inVars.size() + outVars.size();
     simplified_ltl = simplify_spec;
+    storage = _storage;
     
-    // use ltl2dpa tp cpmstruct the tree automaton
-    strix_ltl2dpa::Ltl2DpaConverter converter;
-    strix_aut::AutomatonTreeStructure autoStruct = converter.toAutTreeStruct(ltl_formula, inVars, outVars, simplify_spec);    
+    // use ltl2dpa tp cpmstruct the tree automaton (kept alive for lazy DPAs)
+    std::shared_ptr<strix_ltl2dpa::Ltl2DpaConverter> converter = std::make_shared<strix_ltl2dpa::Ltl2DpaConverter>();
+    std::shared_ptr<strix_aut::AutomatonTreeStructure> tree_structure = 
+        std::make_shared<strix_aut::AutomatonTreeStructure>(converter->toAutTreeStruct(ltl_formula, inVars, outVars, simplify_spec));
+    strix_aut::AutomatonTreeStructure& autoStruct = *tree_structure;
 
     // collect meta-data
     parity =  autoStruct.getParity();
@@ -129,57 +473,102 @@ TotalDPA::TotalDPA(const std::vector<std::string>& _inVars, const std::vector<st
     for(size_t i=0; i<n_io_vars; i++)
         statuses[i] = autoStruct.getVariableStatus(i);
 
-    // a queue for indexes of newly discovered states to be explored
-    std::queue<size_t> to_explore;
-    
+    // the alphabet (reduced to the relevant vars)
+    init_alphabet(alphabet);
+
     // get initial state : put always at index 0
     strix_aut::product_state_t initial_state = autoStruct.getInitialState();
     product_state_size = initial_state.size();
     states.push_back(initial_state);
-
-    // add the initial state to the next to explore + create an edge list for it
-    to_explore.push(0);
     state_edges.push_back(std::vector<TotalDpaEdge>());
     states_is_top.push_back(autoStruct.isTopState(initial_state));
     states_is_bottom.push_back(autoStruct.isBottomState(initial_state));       
 
-    // keep exploring until no more states in the queue
-    while(!to_explore.empty()){
+    // a lazy DPA only knows its initial state for now
+    if(storage == DpaStorage::LAZY){
+        lazy = std::make_shared<LazyDpa>(n_possible_letters + 1);
+        lazy->converter = converter;
+        lazy->structure = tree_structure;
 
-        // get the state idx in the front
-        size_t state_idx = to_explore.front();
-        to_explore.pop();
+        std::lock_guard<std::mutex> lock(lazy->mutex);
+        lazy_add_state(initial_state);
+        return;
+    }
 
-        // get the state itself
-        strix_aut::product_state_t state = states[state_idx];
+    // the states are indexed in their BFS order: the states are explored in the order of their
+    // indices and the new successors get the next indices in the order of (state, letter slot).
+    // the explored states are taken in batches from the front of the BFS queue (the states not
+    // explored yet). the successors of a batch are computed by many threads and then added
+    // serially in the BFS order, so the DPA is identical for any number of threads.
+    // the threads never call OWL: with many threads, the leaf automata are first constructed
+    // concurrently (a worker attached to the OWL isolate per automaton) and the successors of the
+    // leaf automata for the states of a batch are prepared before the threads read them
+    const size_t n_threads = (construction_threads > 0 ? construction_threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+    if(n_threads > 1)
+        autoStruct.constructAutomata(n_threads);
+    const size_t batch_states = std::max<size_t>(1, EXPLORATION_BATCH/n_possible_letters);
+    std::vector<strix_aut::product_state_t> batch_successors;
+    std::vector<strix_aut::ColorScore> batch_cs;
+    std::vector<size_t> batch_successor_idx;
+
+    dpa_state_idx_map.insert(std::make_pair(initial_state, 0));
+    dpa_state_idx_map_ready = true;
 
-        // for all io possibilities
-        // TODO: improve this as done in strix using the Seq iterators
-        // to avoid irrelevant IOs
-        n_possible_letters = std::pow(2,n_io_vars);
-        for(strix_aut::letter_t io_letter=0; io_letter < n_possible_letters; io_letter++){
+    // keep exploring until no more states in the queue
+    size_t next_to_explore = 0;
+    while(next_to_explore < states.size()){
+        const size_t batch_begin = next_to_explore;
+        const size_t batch_end = std::min(states.size(), batch_begin + batch_states);
+        const size_t batch_size = (batch_end - batch_begin)*n_possible_letters;
+        next_to_explore = batch_end;
+
+        if(n_threads > 1)
+            autoStruct.prepareSuccessors(states.cbegin() + batch_begin, states.cbegin() + batch_end);
+
+        // the successors for all the relevant io letters (of the alphabet). the states found
+        // before the batch are looked up here (the map is only read by the threads)
+        batch_successors.assign(batch_size, strix_aut::product_state_t(product_state_size));
+        batch_cs.resize(batch_size);
+        batch_successor_idx.resize(batch_size);
+        work_stealing_for(batch_size, n_threads, 64, [&](size_t start, size_t end) {
+            for(size_t i = start; i < end; i++){
+                const strix_aut::product_state_t& state = states[batch_begin + i/n_possible_letters];
+                const strix_aut::letter_t io_letter = slot_letter(i % n_possible_letters);
+                batch_cs[i] = autoStruct.getSuccessor(state, batch_successors[i], io_letter);
+
+                auto found = dpa_state_idx_map.find(batch_successors[i]);
+                batch_successor_idx[i] = (found == dpa_state_idx_map.end() ? NO_STATE : found->second);
+            }
+        });
 
-            // get the successor
-            strix_aut::product_state_t successor(product_state_size);
-            strix_aut::ColorScore cs = autoStruct.getSuccessor(state, successor, io_letter);
+        // add the new states and the edges in the BFS order
+        for(size_t i = 0; i < batch_size; i++){
+            const size_t state_idx = batch_begin + i/n_possible_letters;
+            const size_t slot = i % n_possible_letters;
+            const strix_aut::product_state_t& successor = batch_successors[i];
 
             // is the successor a new state ? add it to explore list
-            auto successor_info = is_state_in_states(successor);
-            size_t successor_idx = successor_info.second;
-            if(!successor_info.first){
-                successor_idx = states.size();
-                to_explore.push(states.size());
-                states.push_back(successor);
-                state_edges.push_back(std::vector<TotalDpaEdge>());
-                states_is_top.push_back(autoStruct.isTopState(successor));
-                states_is_bottom.push_back(autoStruct.isBottomState(successor));
+            size_t successor_idx = batch_successor_idx[i];
+            if(successor_idx == NO_STATE){
+                auto successor_info = is_state_in_states(successor);
+                successor_idx = successor_info.second;
+                if(!successor_info.first){
+                    successor_idx = states.size();
+                    states.push_back(successor);
+                    state_edges.push_back(std::vector<TotalDpaEdge>());
+                    states_is_top.push_back(autoStruct.isTopState(successor));
+                    states_is_bottom.push_back(autoStruct.isBottomState(successor));
+                    dpa_state_idx_map.insert(std::make_pair(successor, successor_idx));
+                }
             }
 
             // create the edge
-            state_edges[state_idx].push_back(TotalDpaEdge(io_letter, successor, cs, successor_idx));                
+            state_edges[state_idx].push_back(TotalDpaEdge(slot_letter(slot), successor, batch_cs[i], successor_idx));
+            if(slot + 1 == n_possible_letters)
+                compress_state_edges(state_idx);
         }
     }
-    cache_states();
+    build_transition_table();
 }
 
 symbolic_t TotalDPA::getInitialState(){
@@ -196,11 +585,24 @@ atomic_proposition_status_t TotalDPA::getVariableStatus(int variable){
     return statuses[variable];
 }
 size_t TotalDPA::getStatesCount() const {
+    if(storage == DpaStorage::LAZY)
+        return lazy->n_states.load(std::memory_order_acquire);
+    return states.size();
+}
+size_t TotalDPA::getStatesBound() const {
+    if(storage == DpaStorage::LAZY)
+        return std::numeric_limits<uint32_t>::max();
     return states.size();
 }
 size_t TotalDPA::getLettersCount() const {
     return n_possible_letters;
 }
+DpaStorage TotalDPA::getStorage() const {
+    return storage;
+}
+size_t TotalDPA::getTreeNodesCount() const {
+    return tree_nodes.size()/3;
+}
 std::vector<std::string> TotalDPA::getInVars(){
     return inVars;
 }
@@ -211,56 +613,217 @@ std::string TotalDPA::getLtlFormula(){
     return ltl_formula;
 }
 
-strix_aut::ColorScore TotalDPA::getSuccessor(const symbolic_t& state_idx, symbolic_t& successor_idx, const strix_aut::letter_t& io_letter){
+std::string TotalDPA::getCacheKey(const std::vector<std::string>& _inVars, const std::vector<std::string>& _outVars, const std::string& _ltl_formula, bool simplify_spec, const DpaAlphabet& alphabet){
+
+    // the fields are separated by a zero byte (not found in any of them) so no two
+    // different lists of fields have the same text
+    std::stringstream ss;
+    ss << DPA_CACHE_VERSION << '\0' << _ltl_formula << '\0' << simplify_spec << '\0';
+    for(const std::string& var : _inVars)
+        ss << var << ',';
+    ss << '\0';
+    for(const std::string& var : _outVars)
+        ss << var << ',';
+    ss << '\0';
+    // the alphabet as sets (the lists may have many repeated letters)
+    for(const strix_aut::letter_t letter : std::set<strix_aut::letter_t>(alphabet.in_letters.begin(), alphabet.in_letters.end()))
+        ss << letter << ',';
+    ss << '\0';
+    for(const strix_aut::letter_t letter : std::set<strix_aut::letter_t>(alphabet.out_letters.begin(), alphabet.out_letters.end()))
+        ss << letter << ',';
+
+    return OmegaUtils::HashKey(ss.str());
+}
 
-    std::pair<bool, size_t> found_state = is_state_in_states(states[state_idx]);
-    if(!found_state.first)
-        throw std::runtime_error("getSuccessor: The state is not found in the list of states.");
+strix_aut::ColorScore TotalDPA::getSuccessor(const symbolic_t& state_idx, symbolic_t& successor_idx, const strix_aut::letter_t& io_letter) const {
 
-    if(io_letter >= std::pow(2,n_io_vars))
-        throw std::runtime_error("getSuccessor: Invalid IO letter supplied.");
+    if(state_idx >= getStatesCount())
+        throw std::runtime_error("getSuccessor: The state is not found in the list of states.");
 
-    successor_idx = state_edges[found_state.second][io_letter].successor_idx;
-    return state_edges[found_state.second][io_letter].cs;
+    const size_t slot = getLetterSlot(io_letter);
+    successor_idx = getTransition(state_idx, slot).successor_idx;
+    if(storage == DpaStorage::TABLE && transition_scores != nullptr)
+        return strix_aut::ColorScore(transition_table[state_idx*n_possible_letters + slot].color, transition_scores[state_idx*n_possible_letters + slot], 1.0);
+    if(storage == DpaStorage::TABLE)
+        return state_edges[state_idx][slot].cs;
+    if(storage == DpaStorage::DECISION_TREE)
+        return tree_leaf_cs[tree_leaf(state_idx, slot_letter(slot))];
+    return get_edge(state_idx, slot).cs;
 }
 
-bool TotalDPA::isTopState(const symbolic_t& state_idx){
-    std::pair<bool, size_t> found_state = is_state_in_states(states[state_idx]);
-    if(!found_state.first)
-        throw std::runtime_error("isTopState: The state is not found in the list of states.");
+size_t TotalDPA::minimize(const bool normalize_colors, const size_t n_threads){
 
-    return states_is_top[found_state.second];
-}
+    if(storage == DpaStorage::LAZY)
+        throw std::runtime_error("TotalDPA::minimize: a lazy DPA can not be minimized.");
+
+    const size_t n_states = states.size();
+    const size_t n_workers = (n_threads > 0 ? n_threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+    if(n_states == 0)
+        return 0;
+
+    // the blocks of the partition are numbered by their first state, so the initial state
+    // (the first state) is always in the first block. the first partition is by the flags
+    std::vector<uint32_t> blocks(n_states);
+    const uint32_t no_block = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> flag_blocks(4, no_block);
+    size_t n_blocks = 0;
+    for(size_t state_idx = 0; state_idx < n_states; state_idx++){
+        const uint8_t flags = get_state_flags(state_idx);
+        if(flag_blocks[flags] == no_block)
+            flag_blocks[flags] = (uint32_t)n_blocks++;
+        blocks[state_idx] = flag_blocks[flags];
+    }
+
+    // two states stay in the same block if they are in the same block and each of their transitions
+    // has the same color and a successor in the same block
+    auto same_block = [&](const size_t a, const size_t b){
+        if(blocks[a] != blocks[b])
+            return false;
+        for(size_t slot = 0; slot < n_possible_letters; slot++){
+            const DpaTransition ta = getTransition(a, slot);
+            const DpaTransition tb = getTransition(b, slot);
+            if(ta.color != tb.color || blocks[ta.successor_idx] != blocks[tb.successor_idx])
+                return false;
+        }
+        return true;
+    };
+
+    // refine the partition until no block is split: the signatures (hashes of the blocks of the
+    // transitions) are computed concurrently and the states with equal signatures are compared
+    std::vector<uint64_t> signatures(n_states);
+    std::vector<uint32_t> refined(n_states);
+    while(true){
+        work_stealing_for(n_states, n_workers, 64, [&](size_t start, size_t end) {
+            for(size_t state_idx = start; state_idx < end; state_idx++){
+                uint64_t hash = 14695981039346656037ULL ^ blocks[state_idx];
+                for(size_t slot = 0; slot < n_possible_letters; slot++){
+                    const DpaTransition transition = getTransition(state_idx, slot);
+                    hash = (hash ^ blocks[transition.successor_idx]) * 1099511628211ULL;
+                    hash = (hash ^ transition.color) * 1099511628211ULL;
+                }
+                signatures[state_idx] = hash;
+            }
+        });
+
+        std::unordered_map<uint64_t, std::vector<uint32_t>> representatives;
+        size_t n_refined = 0;
+        for(size_t state_idx = 0; state_idx < n_states; state_idx++){
+            std::vector<uint32_t>& candidates = representatives[signatures[state_idx]];
+            auto found = std::find_if(candidates.begin(), candidates.end(), [&](const uint32_t rep){ return same_block(rep, state_idx); });
+            if(found != candidates.end()){
+                refined[state_idx] = refined[*found];
+            }
+            else{
+                refined[state_idx] = (uint32_t)n_refined++;
+                candidates.push_back((uint32_t)state_idx);
+            }
+        }
 
-bool TotalDPA::isBottomState(const symbolic_t& state_idx){
-    std::pair<bool, size_t> found_state = is_state_in_states(states[state_idx]);
-    if(!found_state.first)
-        throw std::runtime_error("isBottomState: The state is not found in the list of states.");
+        blocks.swap(refined);
+        if(n_refined == n_blocks)
+            break;
+        n_blocks = n_refined;
+    }
 
-    return states_is_bottom[found_state.second];
-}    
+    // the colors: the used ones (and the max color) sorted and mapped to consecutive colors of the same parity
+    std::map<strix_aut::color_t, strix_aut::color_t> colors;
+    if(normalize_colors){
+        colors.insert(std::make_pair(max_color, 0));
+        for(size_t state_idx = 0; state_idx < n_states; state_idx++)
+            for(size_t slot = 0; slot < n_possible_letters; slot++)
+                colors.insert(std::make_pair(getTransition(state_idx, slot).color, 0));
+
+        strix_aut::color_t previous = colors.begin()->first;
+        strix_aut::color_t mapped = previous % 2;
+        for(auto& color : colors){
+            if((color.first % 2) != (previous % 2))
+                mapped++;
+            color.second = mapped;
+            previous = color.first;
+        }
+    }
+
+    // the first state of each block represents it
+    std::vector<strix_aut::product_state_t> min_states;
+    std::vector<bool> min_states_is_top, min_states_is_bottom;
+    std::vector<size_t> block_states;
+    for(size_t state_idx = 0; state_idx < n_states; state_idx++){
+        if(blocks[state_idx] == min_states.size()){
+            min_states.push_back(states[state_idx]);
+            min_states_is_top.push_back(states_is_top[state_idx]);
+            min_states_is_bottom.push_back(states_is_bottom[state_idx]);
+            block_states.push_back(state_idx);
+        }
+    }
+
+    std::vector<std::vector<TotalDpaEdge>> min_state_edges(n_blocks);
+    for(size_t block = 0; block < n_blocks; block++){
+        min_state_edges[block].reserve(n_possible_letters);
+        for(size_t slot = 0; slot < n_possible_letters; slot++){
+            TotalDpaEdge edge = get_edge(block_states[block], slot);
+            edge.successor_idx = blocks[edge.successor_idx];
+            edge.successor = min_states[edge.successor_idx];
+            if(normalize_colors)
+                edge.cs.color = colors[edge.cs.color];
+            min_state_edges[block].push_back(edge);
+        }
+    }
+
+    // the merged states are still found (as their blocks)
+    dpa_state_idx_map.clear();
+    for(size_t state_idx = 0; state_idx < n_states; state_idx++)
+        dpa_state_idx_map.insert(std::make_pair(states[state_idx], (size_t)blocks[state_idx]));
+    dpa_state_idx_map_ready = true;
+
+    // replace the states and rebuild the transitions
+    states.swap(min_states);
+    states_is_top.swap(min_states_is_top);
+    states_is_bottom.swap(min_states_is_bottom);
+    state_edges.swap(min_state_edges);
+    if(normalize_colors)
+        max_color = colors[max_color];
+
+    transition_table_owner.reset();
+    transition_table = nullptr;
+    transition_scores = nullptr;
+    tree_roots.clear();
+    tree_nodes.clear();
+    tree_leaves.clear();
+    tree_leaf_cs.clear();
+    for(size_t state_idx = 0; state_idx < states.size(); state_idx++)
+        compress_state_edges(state_idx);
+    build_transition_table();
+
+    return states.size();
+}
 
 void TotalDPA::dumpDPA(std::vector<symbolic_t>& dpa_data){
+    explore_all();
     size_t num_dpa_states = getStatesCount();
     size_t num_dpa_letters = getLettersCount();
 
+    // the dump is indexed by the letters themselves
+    if(num_dpa_letters != ((size_t)1 << n_io_vars))
+        throw std::runtime_error("TotalDPA::dumpDPA: the DPA must have an edge for each of the letters.");
+
     dpa_data.reserve(2*num_dpa_states*num_dpa_letters);
 
     // for each state
     for(size_t state_idx = 0; state_idx < num_dpa_states; state_idx++){
         // add post states for each letter
         for(size_t letter_idx = 0; letter_idx < num_dpa_letters; letter_idx++){
-            dpa_data.push_back(state_edges[state_idx][letter_idx].successor_idx);
+            dpa_data.push_back(getTransition(state_idx, letter_idx).successor_idx);
         }
 
         // add colors for each letter
         for(size_t letter_idx = 0; letter_idx < num_dpa_letters; letter_idx++){
-            dpa_data.push_back(state_edges[state_idx][letter_idx].cs.color);
+            dpa_data.push_back(getTransition(state_idx, letter_idx).color);
         }        
     }
 }
 
 void TotalDPA::printInfo(){
+    explore_all();
     const size_t n_states = states.size();
 
     std::cout << "The DPA has " << n_states << " states." << std::endl;
@@ -275,7 +838,8 @@ void TotalDPA::printInfo(){
         if(states_is_top[i]) std::cout << "[TOP]";
         if(states_is_bottom[i]) std::cout << "[BOTTOM]";
         std::cout << ":" << std::endl;
-        for (auto edge : state_edges[i]){
+        for (size_t slot=0; slot<n_possible_letters; slot++){
+            const TotalDpaEdge edge = get_edge(i, slot);
             std::cout << "\t --(b_IO: ";
             std::bitset<8> io(edge.letter);
             std::cout << io << ", Clr:" << edge.cs.color << ", Scr: " << edge.cs.score;
@@ -286,7 +850,46 @@ void TotalDPA::printInfo(){
     }
 }
 
-void TotalDPA::loadFromFile(const std::string& filename){
+void TotalDPA::add_irrelevant_letters(DpaAlphabet& alphabet) const {
+
+    // the letters only differing in the irrelevant vars of the given letters are added
+    const strix_aut::letter_t in_mask = ((strix_aut::letter_t)1 << inVars.size()) - 1;
+    const strix_aut::letter_t out_mask = ((strix_aut::letter_t)1 << outVars.size()) - 1;
+    const strix_aut::letter_t in_irrelevant = in_mask & ~relevant_bits(0, inVars.size());
+    const strix_aut::letter_t out_irrelevant = out_mask & ~relevant_bits(inVars.size(), outVars.size());
+    DpaAlphabet expanded;
+    for(const strix_aut::letter_t in_letter : alphabet.in_letters){
+        for(strix_aut::letter_t sub = in_irrelevant;; sub = (sub - 1) & in_irrelevant){
+            expanded.in_letters.push_back(in_letter | sub);
+            if(sub == 0) break;
+        }
+    }
+    for(const strix_aut::letter_t out_letter : alphabet.out_letters){
+        for(strix_aut::letter_t sub = out_irrelevant;; sub = (sub - 1) & out_irrelevant){
+            expanded.out_letters.push_back(out_letter | sub);
+            if(sub == 0) break;
+        }
+    }
+    alphabet = expanded;
+}
+
+void TotalDPA::loadFromFile(const std::string& filename, const DpaAlphabet& alphabet){
+
+    // the binary files start with a magic text
+    char magic[sizeof(DPA_FILE_MAGIC)] = {0};
+    std::ifstream ifs(filename, std::ios::binary);
+    if(!ifs.good())
+        throw std::runtime_error(err_invalid_input + "cant open the file " + filename + ".");
+    ifs.read(magic, sizeof(DPA_FILE_MAGIC));
+    ifs.close();
+
+    if(std::equal(magic, magic + sizeof(DPA_FILE_MAGIC), DPA_FILE_MAGIC))
+        load_binary_file(filename, alphabet);
+    else
+        load_text_file(filename, alphabet);
+}
+
+void TotalDPA::load_text_file(const std::string& filename, const DpaAlphabet& alphabet){
     std::ifstream ifs(filename);
     std::string scanned;
 
@@ -420,6 +1023,7 @@ void TotalDPA::loadFromFile(const std::string& filename){
     if(states_is_bottom.size() != n_states)
         throw std::runtime_error(err_invalid_input + "invalid number of states_is_bottom elements.");
 
+    std::vector<std::vector<TotalDpaEdge>> file_edges;
     for(size_t i=0; i<n_states; i++){
         std::string  state_label = std::string("state_") + std::to_string(i) + std::string("_edges:");
 
@@ -428,7 +1032,7 @@ void TotalDPA::loadFromFile(const std::string& filename){
         if(scanned != std::string(state_label))
             throw std::runtime_error(err_invalid_input + "cant find " + state_label);
         else{
-            state_edges.push_back(std::vector<TotalDpaEdge>());
+            file_edges.push_back(std::vector<TotalDpaEdge>());
 
             std::string edges_line;
             std::getline(ifs, edges_line);
@@ -437,13 +1041,54 @@ void TotalDPA::loadFromFile(const std::string& filename){
             std::stringstream ss_edges(edges_line);
             std::string str_edge;
             while(std::getline(ss_edges, str_edge, ';')){
-                state_edges[i].push_back(TotalDpaEdge::parse(str_edge, states));
+                file_edges[i].push_back(TotalDpaEdge::parse(str_edge, states));
             }
         }
     }
+
+    // the alphabet: the requested one or the one of the file (taken from the first state, where
+    // the letters only differing in the irrelevant vars are added back)
+    DpaAlphabet file_alphabet = alphabet;
+    if(file_alphabet.in_letters.empty() && file_alphabet.out_letters.empty() && n_states > 0){
+        const strix_aut::letter_t in_mask = ((strix_aut::letter_t)1 << inVars.size()) - 1;
+        for(const TotalDpaEdge& edge : file_edges[0]){
+            file_alphabet.in_letters.push_back(edge.letter & in_mask);
+            file_alphabet.out_letters.push_back(edge.letter >> inVars.size());
+        }
+        add_irrelevant_letters(file_alphabet);
+    }
+    init_alphabet(file_alphabet);
+
+    // order the edges of each state by the slots of their letters (other edges are dropped)
+    for(size_t i=0; i<n_states; i++){
+        std::unordered_map<strix_aut::letter_t, size_t> edge_of_letter;
+        for(size_t e=0; e<file_edges[i].size(); e++)
+            edge_of_letter.insert({file_edges[i][e].letter, e});
+
+        state_edges.push_back(std::vector<TotalDpaEdge>());
+        state_edges[i].reserve(n_possible_letters);
+        for(size_t slot=0; slot<n_possible_letters; slot++){
+            auto edge = edge_of_letter.find(slot_letter(slot));
+            if(edge == edge_of_letter.end())
+                throw std::runtime_error(err_invalid_input + "the state " + std::to_string(i) + " has no edge for the letter " + std::to_string(slot_letter(slot)) + ".");
+            state_edges[i].push_back(file_edges[i][edge->second]);
+        }
+        compress_state_edges(i);
+    }
+}
+
+void TotalDPA::writeToFile(const std::string& filename, const DpaFileFormat format){
+
+    // a lazy DPA is completely explored first
+    explore_all();
+
+    if(format == DpaFileFormat::BINARY)
+        write_binary_file(filename);
+    else
+        write_text_file(filename);
 }
 
-void TotalDPA::writeToFile(const std::string& filename){
+void TotalDPA::write_text_file(const std::string& filename){
 
     std::ofstream ofs(filename);
 
@@ -482,11 +1127,10 @@ void TotalDPA::writeToFile(const std::string& filename){
     OmegaUtils::print_vector(states_is_bottom, ofs);
     ofs << std::endl;
 
-    size_t idx = 0;
-    for (auto edges : state_edges){
+    for (size_t idx = 0; idx < states.size(); idx++){
         ofs << "state_" << idx << "_edges: ";
-        size_t edge_idx = 0;
-        for(auto edge : edges){
+        for(size_t slot = 0; slot < n_possible_letters; slot++){
+            const TotalDpaEdge edge = get_edge(idx, slot);
             ofs << "{"
                 << edge.letter << ","
                 << edge.successor_idx << ","
@@ -494,15 +1138,237 @@ void TotalDPA::writeToFile(const std::string& filename){
                 << edge.cs.score
                 << "}";
             
-            edge_idx++;
-            if(edge_idx != edges.size())
+            if(slot + 1 != n_possible_letters)
                 ofs << ";";
         }
         ofs << std::endl;
-        idx++;
     }        
     ofs << std::endl;
 
 }
 
-}
\ No newline at end of file
+void TotalDPA::write_binary_file(const std::string& filename){
+
+    const uint64_t n_entries = (uint64_t)states.size()*n_possible_letters;
+    auto aligned = [](const uint64_t offset){ return (offset + DPA_FILE_ALIGNMENT - 1)/DPA_FILE_ALIGNMENT*DPA_FILE_ALIGNMENT; };
+
+    std::string vars;
+    for(const std::string& var : inVars)
+        vars += var + '\0';
+    for(const std::string& var : outVars)
+        vars += var + '\0';
+
+    // the layout
+    DpaFileHeader header;
+    std::memset(&header, 0, sizeof(DpaFileHeader));
+    std::memcpy(header.magic, DPA_FILE_MAGIC, sizeof(DPA_FILE_MAGIC));
+    header.version = DPA_FILE_VERSION;
+    header.byte_order = DPA_FILE_BYTE_ORDER;
+    header.n_in_vars = inVars.size();
+    header.n_out_vars = outVars.size();
+    header.product_state_size = product_state_size;
+    header.n_states = states.size();
+    header.n_in_letters = in_letters.size();
+    header.n_out_letters = out_letters.size();
+    header.parity = (uint32_t)parity;
+    header.max_color = max_color;
+    header.simplified_ltl = simplified_ltl ? 1 : 0;
+    header.vars_offset = aligned(sizeof(DpaFileHeader));
+    header.vars_size = vars.size();
+    header.ltl_formula_offset = aligned(header.vars_offset + header.vars_size);
+    header.ltl_formula_size = ltl_formula.size();
+    header.statuses_offset = aligned(header.ltl_formula_offset + header.ltl_formula_size);
+    header.letters_offset = aligned(header.statuses_offset + sizeof(int32_t)*statuses.size());
+    header.states_offset = aligned(header.letters_offset + sizeof(uint64_t)*(in_letters.size() + out_letters.size()));
+    header.flags_offset = aligned(header.states_offset + sizeof(uint32_t)*states.size()*product_state_size);
+    header.table_offset = aligned(header.flags_offset + states.size());
+    header.scores_offset = aligned(header.table_offset + sizeof(DpaTransition)*n_entries);
+    header.file_size = header.scores_offset + sizeof(double)*n_entries;
+
+    std::ofstream ofs(filename, std::ios::binary);
+    if(!ofs.good())
+        throw std::runtime_error("TotalDPA::write_binary_file: could not open the file " + filename + ".");
+
+    uint64_t position = 0;
+    auto write = [&](const void* data, const uint64_t size, const uint64_t offset){
+        static const char padding[DPA_FILE_ALIGNMENT] = {0};
+        ofs.write(padding, offset - position);
+        ofs.write((const char*)data, size);
+        position = offset + size;
+    };
+
+    write(&header, sizeof(DpaFileHeader), 0);
+    write(vars.data(), vars.size(), header.vars_offset);
+    write(ltl_formula.data(), ltl_formula.size(), header.ltl_formula_offset);
+
+    std::vector<int32_t> file_statuses(statuses.begin(), statuses.end());
+    write(file_statuses.data(), sizeof(int32_t)*file_statuses.size(), header.statuses_offset);
+
+    std::vector<uint64_t> file_letters(in_letters.begin(), in_letters.end());
+    file_letters.insert(file_letters.end(), out_letters.begin(), out_letters.end());
+    write(file_letters.data(), sizeof(uint64_t)*file_letters.size(), header.letters_offset);
+
+    std::vector<uint32_t> file_states;
+    file_states.reserve(states.size()*product_state_size);
+    for(const strix_aut::product_state_t& state : states)
+        file_states.insert(file_states.end(), state.begin(), state.end());
+    write(file_states.data(), sizeof(uint32_t)*file_states.size(), header.states_offset);
+
+    std::vector<uint8_t> file_flags(states.size());
+    for(size_t state_idx = 0; state_idx < states.size(); state_idx++)
+        file_flags[state_idx] = get_state_flags(state_idx);
+    write(file_flags.data(), file_flags.size(), header.flags_offset);
+
+    // the table and the scores (row by row)
+    std::vector<DpaTransition> row(n_possible_letters);
+    std::vector<double> scores(n_possible_letters);
+    write(nullptr, 0, header.table_offset);
+    for(size_t state_idx = 0; state_idx < states.size(); state_idx++){
+        for(size_t slot = 0; slot < n_possible_letters; slot++)
+            row[slot] = getTransition(state_idx, slot);
+        write(row.data(), sizeof(DpaTransition)*n_possible_letters, position);
+    }
+    write(nullptr, 0, header.scores_offset);
+    for(size_t state_idx = 0; state_idx < states.size(); state_idx++){
+        for(size_t slot = 0; slot < n_possible_letters; slot++)
+            scores[slot] = get_edge(state_idx, slot).cs.score;
+        write(scores.data(), sizeof(double)*n_possible_letters, position);
+    }
+
+    if(!ofs.good())
+        throw std::runtime_error("TotalDPA::write_binary_file: could not write the file " + filename + ".");
+}
+
+void TotalDPA::load_binary_file(const std::string& filename, const DpaAlphabet& alphabet){
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(filename);
+    if(file->size() < sizeof(DpaFileHeader))
+        throw std::runtime_error(err_invalid_input + "the binary file is too small.");
+
+    DpaFileHeader header;
+    std::memcpy(&header, file->data(), sizeof(DpaFileHeader));
+    if(header.byte_order != DPA_FILE_BYTE_ORDER)
+        throw std::runtime_error(err_invalid_input + "the binary file was written on a machine with another byte order.");
+    if(header.version != DPA_FILE_VERSION)
+        throw std::runtime_error(err_invalid_input + "unsupported version (" + std::to_string(header.version) + ") of the binary file.");
+    if(header.file_size != file->size())
+        throw std::runtime_error(err_invalid_input + "the binary file is truncated.");
+
+    // the sections have to follow each other within the file (a cached file may be corrupt)
+    auto checked_product = [&](const uint64_t a, const uint64_t b){
+        if(a != 0 && b > std::numeric_limits<uint64_t>::max()/a)
+            throw std::runtime_error(err_invalid_input + "invalid sizes in the binary file.");
+        return a*b;
+    };
+    uint64_t sections_end = sizeof(DpaFileHeader);
+    auto check_section = [&](const uint64_t offset, const uint64_t n_items, const uint64_t item_size){
+        if(offset < sections_end || offset > header.file_size || n_items > (header.file_size - offset)/item_size)
+            throw std::runtime_error(err_invalid_input + "invalid sections of the binary file.");
+        sections_end = offset + n_items*item_size;
+    };
+
+    const uint64_t n_states = header.n_states;
+    const uint64_t n_file_letters = checked_product(header.n_in_letters, header.n_out_letters);
+    const uint64_t n_entries = checked_product(n_states, n_file_letters);
+    check_section(header.vars_offset, header.vars_size, 1);
+    check_section(header.ltl_formula_offset, header.ltl_formula_size, 1);
+    check_section(header.statuses_offset, header.n_in_vars + header.n_out_vars, sizeof(int32_t));
+    check_section(header.letters_offset, header.n_in_letters + header.n_out_letters, sizeof(uint64_t));
+    check_section(header.states_offset, checked_product(n_states, header.product_state_size), sizeof(uint32_t));
+    check_section(header.flags_offset, n_states, sizeof(uint8_t));
+    check_section(header.table_offset, n_entries, sizeof(DpaTransition));
+    check_section(header.scores_offset, n_entries, sizeof(double));
+    if(sections_end != header.file_size || header.table_offset % DPA_FILE_ALIGNMENT != 0)
+        throw std::runtime_error(err_invalid_input + "invalid sections of the binary file.");
+
+    // the metadata
+    const char* vars = file->data() + header.vars_offset;
+    const char* vars_end = vars + header.vars_size;
+    inVars.clear();
+    outVars.clear();
+    while(vars < vars_end){
+        const char* var_end = (const char*)std::memchr(vars, '\0', vars_end - vars);
+        if(var_end == nullptr)
+            throw std::runtime_error(err_invalid_input + "invalid IO vars.");
+        const std::string var(vars, var_end);
+        if(inVars.size() < header.n_in_vars)
+            inVars.push_back(var);
+        else
+            outVars.push_back(var);
+        vars = var_end + 1;
+    }
+    if(inVars.size() != header.n_in_vars || outVars.size() != header.n_out_vars)
+        throw std::runtime_error(err_invalid_input + "invalid number of IO vars.");
+
+    ltl_formula = std::string(file->data() + header.ltl_formula_offset, header.ltl_formula_size);
+    n_io_vars = inVars.size() + outVars.size();
+    product_state_size = header.product_state_size;
+    simplified_ltl = (header.simplified_ltl != 0);
+    parity = (header.parity == 0 ? strix_aut::Parity::EVEN : strix_aut::Parity::ODD);
+    max_color = header.max_color;
+
+    const int32_t* file_statuses = (const int32_t*)(file->data() + header.statuses_offset);
+    statuses.assign(n_io_vars, USED);
+    for(size_t i = 0; i < n_io_vars; i++)
+        statuses[i] = (atomic_proposition_status_t)file_statuses[i];
+
+    // the states
+    const uint32_t* file_states = (const uint32_t*)(file->data() + header.states_offset);
+    const uint8_t* file_flags = (const uint8_t*)(file->data() + header.flags_offset);
+    states.resize(n_states);
+    states_is_top.resize(n_states);
+    states_is_bottom.resize(n_states);
+    for(size_t state_idx = 0; state_idx < n_states; state_idx++){
+        states[state_idx].assign(file_states + state_idx*product_state_size, file_states + (state_idx + 1)*product_state_size);
+        states_is_top[state_idx] = (file_flags[state_idx] & STATE_FLAG_TOP) != 0;
+        states_is_bottom[state_idx] = (file_flags[state_idx] & STATE_FLAG_BOTTOM) != 0;
+    }
+
+    // the alphabet: the requested one or the one of the file
+    const uint64_t* file_letters = (const uint64_t*)(file->data() + header.letters_offset);
+    const std::vector<strix_aut::letter_t> file_in_letters(file_letters, file_letters + header.n_in_letters);
+    const std::vector<strix_aut::letter_t> file_out_letters(file_letters + header.n_in_letters, file_letters + header.n_in_letters + header.n_out_letters);
+    DpaAlphabet file_alphabet = alphabet;
+    if(file_alphabet.in_letters.empty() && file_alphabet.out_letters.empty()){
+        file_alphabet.in_letters = file_in_letters;
+        file_alphabet.out_letters = file_out_letters;
+        add_irrelevant_letters(file_alphabet);
+    }
+    init_alphabet(file_alphabet);
+
+    const DpaTransition* file_table = (const DpaTransition*)(file->data() + header.table_offset);
+    const double* file_scores = (const double*)(file->data() + header.scores_offset);
+    for(uint64_t i = 0; i < n_entries; i++)
+        if(file_table[i].successor_idx >= n_states)
+            throw std::runtime_error(err_invalid_input + "invalid successor in the transition table of the binary file.");
+
+    // the same slots as in the file: the table of the file is used directly
+    if(storage == DpaStorage::TABLE && in_letters == file_in_letters && out_letters == file_out_letters){
+        transition_table = file_table;
+        transition_scores = file_scores;
+        transition_table_owner = file;
+        return;
+    }
+
+    // otherwise, the edges are taken from the slots of the file
+    for(size_t state_idx = 0; state_idx < n_states; state_idx++){
+        state_edges.push_back(std::vector<TotalDpaEdge>());
+        state_edges[state_idx].reserve(n_possible_letters);
+        for(size_t slot = 0; slot < n_possible_letters; slot++){
+            const strix_aut::letter_t in_letter = in_letters[slot % in_letters.size()];
+            const strix_aut::letter_t out_letter = out_letters[slot / in_letters.size()];
+            auto file_in = std::lower_bound(file_in_letters.begin(), file_in_letters.end(), in_letter);
+            auto file_out = std::lower_bound(file_out_letters.begin(), file_out_letters.end(), out_letter);
+            if(file_in == file_in_letters.end() || *file_in != in_letter || file_out == file_out_letters.end() || *file_out != out_letter)
+                throw std::runtime_error(err_invalid_input + "the state " + std::to_string(state_idx) + " has no edge for the letter " + std::to_string(slot_letter(slot)) + ".");
+
+            const size_t file_entry = state_idx*n_file_letters + (size_t)(file_in - file_in_letters.begin()) + (size_t)(file_out - file_out_letters.begin())*header.n_in_letters;
+            const DpaTransition& transition = file_table[file_entry];
+            const strix_aut::ColorScore cs(transition.color, file_scores[file_entry], 1.0);
+            state_edges[state_idx].push_back(TotalDpaEdge(slot_letter(slot), states[transition.successor_idx], cs, transition.successor_idx));
+        }
+        compress_state_edges(state_idx);
+    }
+}
+
+}
@@ -16,6 +16,10 @@
 #include <vector>
 #include <map>
 #include <cmath>
+#include <limits>
+#include <memory>
+#include <atomic>
+#include <mutex>
 
 #include <Ltl2Dpa.h>
 #include <pfaces-sdk.h>
@@ -39,6 +43,85 @@ public:
 };
 
 
+// an entry in the dense transition table of a total DPA
+struct DpaTransition {
+    uint32_t successor_idx;
+    strix_aut::color_t color;
+};
+
+
+// the alphabet of a TotalDPA: the letters (in_letter | out_letter << n_in_vars) for all the 
+// combinations of the given in/out letters. empty lists stand for all the possible in/out
+// letters (i.e., the complete alphabet of the 2^n_io_vars letters)
+struct DpaAlphabet {
+    std::vector<strix_aut::letter_t> in_letters;
+    std::vector<strix_aut::letter_t> out_letters;
+};
+
+
+// the storage of the transitions of a TotalDPA: a dense table (a row of all letters per state) or
+// a decision tree per state over the bits of the letters. the trees are much smaller than the rows
+// when the transitions of the states only depend on a few of the APs. a lazy DPA computes (and
+// memoizes) only the transitions that are asked for, so unreached states are never explored
+enum class DpaStorage {
+    TABLE,
+    DECISION_TREE,
+    LAZY
+};
+
+
+// the formats of the DPA files: a text file or a binary file (see writeToFile) that is memory-mapped
+// when loaded, where its transition table is used directly (without parsing it)
+enum class DpaFileFormat {
+    TEXT,
+    BINARY
+};
+
+
+// the on-demand part of a lazy TotalDPA: the tree structure (and the converter owning its OWL
+// isolate) to query and the product states found so far. the rows of transitions are kept in
+// segments (segment s has 2^s rows) that never move so the memoized entries (0: not computed
+// yet, otherwise VALID | color << 32 | successor) are read without locking. the entry after the
+// letters of a row holds the top/bottom flags of the state
+struct LazyDpa {
+    static constexpr size_t N_SEGMENTS = 32;
+    static constexpr uint64_t VALID = (uint64_t)1 << 63;
+
+    std::shared_ptr<strix_ltl2dpa::Ltl2DpaConverter> converter;
+    std::shared_ptr<strix_aut::AutomatonTreeStructure> structure;
+
+    // guards the states and the queries of the structure
+    std::mutex mutex;
+    std::vector<strix_aut::product_state_t> states;
+    std::vector<bool> states_is_top;
+    std::vector<bool> states_is_bottom;
+    std::map<strix_aut::product_state_t, size_t> state_idx_map;
+
+    const size_t row_size;
+    std::atomic<size_t> n_states;
+    std::atomic<std::atomic<uint64_t>*> segments[N_SEGMENTS];
+
+    LazyDpa(const size_t _row_size);
+    ~LazyDpa();
+
+    static size_t segment_of(const size_t state_idx) {
+        size_t v = state_idx + 1;
+        size_t segment = 0;
+        if(v >> 16){ v >>= 16; segment += 16; }
+        if(v >> 8){ v >>= 8; segment += 8; }
+        if(v >> 4){ v >>= 4; segment += 4; }
+        if(v >> 2){ v >>= 2; segment += 2; }
+        if(v >> 1){ segment += 1; }
+        return segment;
+    }
+
+    std::atomic<uint64_t>* row(const size_t state_idx) const {
+        const size_t segment = segment_of(state_idx);
+        return segments[segment].load(std::memory_order_acquire) + (state_idx + 1 - ((size_t)1 << segment))*row_size;
+    }
+};
+
+
 // the TotalDPA (transitions defined for all input-letters and all states)
 // this is developed to ease the later parallel implementation
 class TotalDPA{
@@ -51,6 +134,21 @@ class TotalDPA{
     size_t n_possible_letters;
     size_t product_state_size;
 
+    // the alphabet: the edges of a state are stored per letter slot, where the slot of the
+    // letter (in_letter | out_letter << n_in_vars) is (in_slot + out_slot*n_in_slots).
+    // the in/out letters are masked by the relevant (USED) vars so letters differing only
+    // in UNUSED/CONSTANT vars share one slot (and one OWL query during the construction)
+    static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+    std::vector<strix_aut::letter_t> in_letters;
+    std::vector<strix_aut::letter_t> out_letters;
+    std::vector<uint32_t> in_letter_slots;
+    std::vector<uint32_t> out_letter_slots;
+    strix_aut::letter_t relevant_bits(const size_t first_var, const size_t n_vars) const;
+    void init_alphabet(const DpaAlphabet& alphabet);
+    strix_aut::letter_t slot_letter(const size_t slot) const {
+        return in_letters[slot % in_letters.size()] | (out_letters[slot / in_letters.size()] << inVars.size());
+    }
+
     // DPA metadata
     bool simplified_ltl;
     strix_aut::Parity parity;
@@ -65,6 +163,65 @@ class TotalDPA{
     // per state: a list of edges
     std::vector<std::vector<TotalDpaEdge>> state_edges;
 
+    // a dense transition table: the transition of (state, letter) is at entry
+    // (state*n_possible_letters + letter_slot), where the table starts at a cache-line boundary.
+    // the table is held by transition_table_owner (a vector or a mapped binary file, shared by the
+    // copies of the DPA). for a mapped file, the scores of the transitions are also in the file
+    // (and state_edges is empty). the top/bottom flags are packed per state
+    static constexpr uint8_t STATE_FLAG_TOP = 1;
+    static constexpr uint8_t STATE_FLAG_BOTTOM = 2;
+    std::shared_ptr<const void> transition_table_owner;
+    const DpaTransition* transition_table = nullptr;
+    const double* transition_scores = nullptr;
+    std::vector<uint8_t> state_flags;
+
+    // building the dense table (after all states/edges are known)
+    void build_transition_table();
+
+    // reading/writing the files (of both formats)
+    void load_text_file(const std::string& filename, const DpaAlphabet& alphabet);
+    void load_binary_file(const std::string& filename, const DpaAlphabet& alphabet);
+    void write_text_file(const std::string& filename);
+    void write_binary_file(const std::string& filename);
+    void add_irrelevant_letters(DpaAlphabet& alphabet) const;
+
+    // the decision trees (DpaStorage::DECISION_TREE): the nodes are triples (var bit, false child, true child)
+    // in tree_nodes where the roots/children < 0 refer to the leaves (-i-1) in tree_leaves (with their
+    // color/score in tree_leaf_cs). the edges of a state are compressed to its tree once it is explored
+    DpaStorage storage;
+    std::vector<int32_t> tree_nodes;
+    std::vector<int32_t> tree_roots;
+    std::vector<DpaTransition> tree_leaves;
+    std::vector<strix_aut::ColorScore> tree_leaf_cs;
+    int32_t build_tree(const std::vector<TotalDpaEdge>& edges, std::vector<size_t>& slots, const size_t begin, const size_t end, const size_t first_leaf);
+    void compress_state_edges(const size_t state_idx);
+    TotalDpaEdge get_edge(const size_t state_idx, const size_t slot) const;
+
+    // the lazy part (DpaStorage::LAZY)
+    std::shared_ptr<LazyDpa> lazy;
+    size_t lazy_add_state(const strix_aut::product_state_t& state) const;
+    DpaTransition compute_lazy_transition(const symbolic_t state_idx, const size_t letter_slot) const;
+    void explore_all();
+    DpaTransition lazy_transition(const symbolic_t state_idx, const size_t letter_slot) const {
+        const uint64_t entry = lazy->row(state_idx)[letter_slot].load(std::memory_order_acquire);
+        if(entry == 0)
+            return compute_lazy_transition(state_idx, letter_slot);
+        return DpaTransition({(uint32_t)entry, (strix_aut::color_t)((entry & ~LazyDpa::VALID) >> 32)});
+    }
+    uint8_t get_state_flags(const symbolic_t state_idx) const {
+        if(storage == DpaStorage::LAZY)
+            return (uint8_t)lazy->row(state_idx)[n_possible_letters].load(std::memory_order_acquire);
+        return state_flags[state_idx];
+    }
+
+    // the leaf of a state's tree for a letter (branchless walk down the tree)
+    size_t tree_leaf(const symbolic_t state_idx, const strix_aut::letter_t io_letter) const {
+        int32_t i = tree_roots[state_idx];
+        while(i >= 0)
+            i = tree_nodes[i + 1 + ((io_letter >> tree_nodes[i]) & 1)];
+        return (size_t)(-i-1);
+    }
+
     // a private function to check
     inline std::pair<bool, size_t> is_state_in_states(const strix_aut::product_state_t& state);
 
@@ -81,8 +238,9 @@ class TotalDPA{
 public:
 
     // constructors
-    TotalDPA(const std::string& filename);
-    TotalDPA(const std::vector<std::string>& _inVars, const std::vector<std::string>& _outVars, const std::string& _ltl_formula, bool simplify_spec = false);
+    TotalDPA(const std::string& filename, const DpaAlphabet& alphabet = DpaAlphabet(), const DpaStorage _storage = DpaStorage::TABLE);
+    // construction_threads: the threads exploring the states from the LTL formula (zero for all the hardware threads)
+    TotalDPA(const std::vector<std::string>& _inVars, const std::vector<std::string>& _outVars, const std::string& _ltl_formula, bool simplify_spec = false, const DpaAlphabet& alphabet = DpaAlphabet(), const DpaStorage _storage = DpaStorage::TABLE, const size_t construction_threads = 1);
 
     // getters
     symbolic_t getInitialState();
@@ -91,16 +249,48 @@ public:
     atomic_proposition_status_t getVariableStatus(int variable);
     size_t getStatesCount() const;
     size_t getLettersCount() const;
+    size_t getStatesBound() const;
+    bool hasCompleteAlphabet() const;
+    DpaStorage getStorage() const;
+    size_t getTreeNodesCount() const;
     std::vector<std::string> getInVars();
     std::vector<std::string> getOutVars();
     std::string getLtlFormula();
 
+    // a key (16 hex digits) of the DPA constructed from an LTL formula with the given vars and alphabet,
+    // used to cache the constructed DPAs in files
+    static std::string getCacheKey(const std::vector<std::string>& _inVars, const std::vector<std::string>& _outVars, const std::string& _ltl_formula, bool simplify_spec, const DpaAlphabet& alphabet);
+
     // get the successor DPA state (yes it is only one successor as it is a (D)PA)
-    strix_aut::ColorScore getSuccessor(const symbolic_t& state_idx, symbolic_t& successor_idx, const strix_aut::letter_t& io_letter);
+    strix_aut::ColorScore getSuccessor(const symbolic_t& state_idx, symbolic_t& successor_idx, const strix_aut::letter_t& io_letter) const;
+
+    // the slot of a letter in the alphabet (throws if the letter is not in the alphabet)
+    size_t getLetterSlot(const strix_aut::letter_t& io_letter) const;
+
+    // the transition (successor + color) of a state under a letter slot from the dense table (or the tree,
+    // or the lazy rows). no checks are done here as this is used in the hot loops of the game construction
+    DpaTransition getTransition(const symbolic_t state_idx, const size_t letter_slot) const {
+        if(storage == DpaStorage::TABLE)
+            return transition_table[state_idx*n_possible_letters + letter_slot];
+        if(storage == DpaStorage::DECISION_TREE)
+            return tree_leaves[tree_leaf(state_idx, slot_letter(letter_slot))];
+        return lazy_transition(state_idx, letter_slot);
+    }
 
     // is a state TOP/BUTTOM ?
-    bool isTopState(const symbolic_t& state_idx);
-    bool isBottomState(const symbolic_t& state_idx);
+    bool isTopState(const symbolic_t& state_idx) const {
+        return (get_state_flags(state_idx) & STATE_FLAG_TOP) != 0;
+    }
+    bool isBottomState(const symbolic_t& state_idx) const {
+        return (get_state_flags(state_idx) & STATE_FLAG_BOTTOM) != 0;
+    }
+
+    // minimize the DPA: the states with the same TOP/BOTTOM flags and, for each letter, the same
+    // color and equivalent successors are merged (partition refinement over the transitions). the
+    // colors can also be normalized: mapped to the fewest colors keeping their order and parity.
+    // the refinement runs on many threads (zero for all the hardware threads). returns the number
+    // of states after the minimization (the initial state stays the first state)
+    size_t minimize(const bool normalize_colors = false, const size_t n_threads = 1);
 
     // dump the dpa to memory
     // the vector will contain a groups of symbolic_t values
@@ -112,9 +302,9 @@ public:
     // print the DPA info
     void printInfo();
 
-    // write/load the DPA to/from a file
-    void loadFromFile(const std::string& filename);
-    void writeToFile(const std::string& filename);
+    // write/load the DPA to/from a file (the format of a loaded file is detected from its first bytes)
+    void loadFromFile(const std::string& filename, const DpaAlphabet& alphabet = DpaAlphabet());
+    void writeToFile(const std::string& filename, const DpaFileFormat format = DpaFileFormat::TEXT);
 };
 
 }
\ No newline at end of file
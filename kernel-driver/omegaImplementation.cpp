@@ -341,13 +341,10 @@ void Machine<T, L1, L2>::constructMealyMachine(PGame<T, L1, L2>& arena, PGSolver
             for (strix_aut::edge_id_t sys_edge = arena.getSysSuccsBegin(sys_node); sys_edge != arena.getSysSuccsEnd(sys_node); sys_edge++) {
                 if (solver.get_sys_successor(sys_edge)) {
                     auto edge = arena.getSysEdge(sys_edge);
-                    std::vector<symbolic_t> sys_outputs = arena.getSysOutput(sys_edge);
+                    ControlSet sys_outputs = arena.getSysOutput(sys_edge);
 
-                    auto const result = successor_list.insert({ edge.successor, sys_outputs });
-                    if (!result.second) {
-                        for (auto item : sys_outputs)
-                            result.first->second.push_back(item);    
-                    }
+                    auto const result = successor_list.insert({ edge.successor, {} });
+                    result.first->second.insert(result.first->second.end(), sys_outputs.begin(), sys_outputs.end());
                 }
             }
 
@@ -396,17 +393,14 @@ void Machine<T, L1, L2>::constructMealyMachine(PGame<T, L1, L2>& arena, PGSolver
             }
 
             // add outputs to state
-            std::vector<symbolic_t> sys_outputs = succ_it->second;
+            const std::vector<symbolic_t>& sys_outputs = succ_it->second;
 
             if (mealy_successor != TOP_STATE || sys_outputs[0] != any_output) {
-                std::vector<symbolic_t> env_inputs = arena.getEnvInput(env_edge);
+                SymbolSpan env_inputs = arena.getEnvInput(env_edge);
 
                 MachineSuccessor mealy_combined_successor(mealy_successor, sys_outputs);
-                auto const result = input_list.insert({ mealy_combined_successor, env_inputs });
-                if (!result.second) {
-                    for(auto item : env_inputs)
-                        result.first->second.push_back(item);    
-                }
+                auto const result = input_list.insert({ mealy_combined_successor, {} });
+                result.first->second.insert(result.first->second.end(), env_inputs.begin(), env_inputs.end());
             }
         }
 
@@ -8,11 +8,18 @@
 */
 
 #include "omegaParityGames.h"
+#include "omegaUtils.h"
 
 #include <iomanip>
 #include <map>
 #include <queue>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 #include <boost/functional/hash.hpp>
@@ -46,17 +53,6 @@ struct std::hash<pFacesOmegaKernels::GameEdge> {
 
 namespace pFacesOmegaKernels{
 
-// boost-based container hash
-template <typename Container>
-struct container_hash {
-    std::size_t operator()(Container const& c) const {
-        std::size_t seed = 0;
-        boost::hash_combine(seed, std::get<0>(c));
-        boost::hash_combine(seed, std::get<1>(c).value);
-        boost::hash_combine(seed, std::get<2>(c));
-        return seed;
-    }
-};
 
 
 // ------------------------------------------
@@ -88,6 +84,71 @@ size_t hash_value(const GameEdge& edge) {
 }
 
 
+// ------------------------------------------
+// class ControlSet
+// ------------------------------------------
+ControlSet::ENCODING ControlSet::encode(const std::vector<symbolic_t>& symbols, std::vector<uint64_t>& words) {
+
+    if (symbols.empty())
+        return LIST;
+
+    // the size of each encoding
+    size_t n_runs = 1;
+    for (size_t i = 1; i < symbols.size(); i++)
+        if (symbols[i] != symbols[i - 1] + 1)
+            n_runs++;
+
+    const uint64_t first_block = symbols.front() / 64;
+    const uint64_t last_block = symbols.back() / 64;
+    const size_t list_words = symbols.size();
+    const size_t intervals_words = 2 * n_runs;
+    const size_t bitset_words = 1 + (last_block - first_block + 1);
+
+    // pick the smallest one
+    if (list_words <= intervals_words && list_words <= bitset_words) {
+        words.insert(words.end(), symbols.cbegin(), symbols.cend());
+        return LIST;
+    }
+    else if (intervals_words <= bitset_words) {
+        words.push_back(symbols.front());
+        for (size_t i = 1; i < symbols.size(); i++) {
+            if (symbols[i] != symbols[i - 1] + 1) {
+                words.push_back(symbols[i - 1]);
+                words.push_back(symbols[i]);
+            }
+        }
+        words.push_back(symbols.back());
+        return INTERVALS;
+    }
+    else {
+        const size_t offset = words.size() + 1;
+        words.push_back(first_block);
+        words.resize(words.size() + (last_block - first_block + 1), 0);
+        for (symbolic_t symbol : symbols)
+            words[offset + (symbol / 64 - first_block)] |= ((uint64_t)1 << (symbol % 64));
+        return BITSET;
+    }
+}
+
+size_t ControlSet::size() const {
+    if (encoding == LIST) {
+        return (size_t)(last - first);
+    }
+    else if (encoding == INTERVALS) {
+        size_t n = 0;
+        for (const uint64_t* word = first; word != last; word += 2)
+            n += word[1] - word[0] + 1;
+        return n;
+    }
+    else {
+        size_t n = 0;
+        for (const uint64_t* word = first + 1; word < last; word++)
+            n += std::bitset<64>(*word).count();
+        return n;
+    }
+}
+
+
 // ------------------------------------------
 // class ScoredProductState
 // ------------------------------------------
@@ -119,13 +180,183 @@ typedef PQ<ScoredProductState, std::deque<ScoredProductState>, ScoredProductStat
 typedef std::tuple<symbolic_t, SymState, symbolic_t> env_state_t;
 
 
+// a 128-bit key for env states that do not fit in 64 bits
+struct EnvStateKey128 {
+    uint64_t hi;
+    uint64_t lo;
+
+    bool operator==(const EnvStateKey128& other) const {
+        return (hi == other.hi) && (lo == other.lo);
+    }
+};
+
+// packs an env state (q, x, u) in a 64-bit key when the bits of the three parts fit in
+// 64 bits. otherwise, q goes to the high word of a 128-bit key and (x, u) to the low one.
+// the value of a SymState is unique over all its types (dummy/overflow states get values
+// beyond the normal ones) so the type is not needed in the key
+class EnvStateKeyPacker {
+    size_t bits_x;
+    size_t bits_u;
+    size_t bits_q;
+
+    static size_t bits_for(const uint64_t max_value) {
+        size_t bits = 1;
+        while (bits < 64 && (max_value >> bits) != 0)
+            bits++;
+        return bits;
+    }
+
+public:
+    EnvStateKeyPacker(const size_t n_dpa_states, const size_t n_sym_states, const size_t n_sym_controls) {
+        bits_q = bits_for(n_dpa_states);
+        bits_x = bits_for(n_sym_states + 1);    // the dummy state has the largest value
+        bits_u = bits_for(n_sym_controls);
+
+        if (bits_x + bits_u > 64)
+            throw std::runtime_error("EnvStateKeyPacker::EnvStateKeyPacker: the symbolic model is too large to pack its states and controls in 64 bits.");
+    }
+
+    bool fits_64() const {
+        return (bits_q + bits_x + bits_u) <= 64;
+    }
+
+    void pack(const symbolic_t q, const SymState& x, const symbolic_t u, uint64_t& key) const {
+        key = (((uint64_t)q << bits_x | (uint64_t)x.value) << bits_u) | (uint64_t)u;
+    }
+
+    void pack(const symbolic_t q, const SymState& x, const symbolic_t u, EnvStateKey128& key) const {
+        key.hi = (uint64_t)q;
+        key.lo = ((uint64_t)x.value << bits_u) | (uint64_t)u;
+    }
+};
+
+// a hash for the packed keys (the finalizer of splitmix64)
+inline uint64_t mix_key(uint64_t key) {
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+inline uint64_t hash_key(const uint64_t key) {
+    return mix_key(key);
+}
+
+inline uint64_t hash_key(const EnvStateKey128& key) {
+    return mix_key(key.hi ^ mix_key(key.lo));
+}
+
+
+// an open-addressing (linear probing) hash table from packed env-state keys to ref ids.
+// keys and ids are kept in two flat arrays and a slot is free when its id is NODE_NONE.
+// the table is kept at most half full and is doubled when it gets fuller
+template <class K>
+class FlatStateTable {
+    std::vector<K> keys;
+    std::vector<strix_aut::node_id_t> ids;
+    size_t mask;
+    size_t n_items;
+
+    void rehash(const size_t capacity) {
+        std::vector<K> old_keys(capacity);
+        std::vector<strix_aut::node_id_t> old_ids(capacity, strix_aut::NODE_NONE);
+        old_keys.swap(keys);
+        old_ids.swap(ids);
+        mask = capacity - 1;
+
+        for (size_t i = 0; i < old_ids.size(); i++) {
+            if (old_ids[i] == strix_aut::NODE_NONE)
+                continue;
+            size_t slot = hash_key(old_keys[i]) & mask;
+            while (ids[slot] != strix_aut::NODE_NONE)
+                slot = (slot + 1) & mask;
+            keys[slot] = old_keys[i];
+            ids[slot] = old_ids[i];
+        }
+    }
+
+public:
+    explicit FlatStateTable(const size_t expected_items = 0):mask(0), n_items(0) {
+        size_t capacity = 16;
+        while (capacity < 2 * expected_items)
+            capacity <<= 1;
+        rehash(capacity);
+    }
+
+    // returns the id of the key and a flag if the key is new. the id of a new key is
+    // taken from a call to new_id()
+    template <typename NewId>
+    std::pair<strix_aut::node_id_t, bool> insert(const K& key, const uint64_t hash, NewId&& new_id) {
+        if (2 * (n_items + 1) > ids.size())
+            rehash(2 * ids.size());
+
+        size_t slot = hash & mask;
+        while (ids[slot] != strix_aut::NODE_NONE) {
+            if (keys[slot] == key)
+                return { ids[slot], false };
+            slot = (slot + 1) & mask;
+        }
+
+        keys[slot] = key;
+        ids[slot] = new_id();
+        n_items++;
+        return { ids[slot], true };
+    }
+
+    template <typename NewId>
+    std::pair<strix_aut::node_id_t, bool> insert(const K& key, NewId&& new_id) {
+        return insert(key, hash_key(key), new_id);
+    }
+
+    size_t size() const {
+        return n_items;
+    }
+};
+
+
+// a map from packed env states to ids that can be used by many threads at once.
+// the states are spread over shards, each a flat table guarded by its own lock, and
+// every new state gets the next id of a shared counter
+template <class K>
+class ConcurrentStateMap {
+    static constexpr size_t N_SHARDS = 256;
+
+    struct Shard {
+        std::mutex lock;
+        FlatStateTable<K> table;
+    };
+
+    std::vector<Shard> shards;
+    std::atomic<strix_aut::node_id_t> n_ids;
+
+public:
+    explicit ConcurrentStateMap(const size_t expected_items = 0):shards(N_SHARDS), n_ids(0){
+        for (Shard& shard : shards)
+            shard.table = FlatStateTable<K>(expected_items / N_SHARDS);
+    }
+
+    // returns the id of the state and a flag if the state is new
+    std::pair<strix_aut::node_id_t, bool> insert(const K& key) {
+        const uint64_t hash = hash_key(key);
+        Shard& shard = shards[(hash >> 56) % N_SHARDS];
+
+        std::lock_guard<std::mutex> guard(shard.lock);
+        return shard.table.insert(key, hash, [this]() { return n_ids++; });
+    }
+
+    strix_aut::node_id_t size() const {
+        return n_ids;
+    }
+};
+
+
 // ------------------------------------------
 // class PGame
 // ------------------------------------------
 template<class T, class L1, class L2>
-PGame<T, L1, L2>::PGame(SymSpec<L1, L2>& _sym_spec, SymModel<T>& _sym_model):
+PGame<T, L1, L2>::PGame(SymSpec<L1, L2>& _sym_spec, SymModel<T>& _sym_model, bool _parallel_construction, size_t _construction_threads):
 sym_spec(_sym_spec), sym_model(_sym_model), initial_node(0),
 n_env_nodes(0), n_sys_nodes(0), n_sys_edges(0), n_env_edges(0),
+parallel_construction(_parallel_construction), construction_threads(_construction_threads),
 n_inputs(_sym_spec.count_state_APs()), n_outputs(_sym_spec.count_control_APs()),
 complete(false), 
 parity(_sym_spec.dpa.getParity()), n_colors(_sym_spec.dpa.getMaxColor() + 1){
@@ -133,9 +364,12 @@ parity(_sym_spec.dpa.getParity()), n_colors(_sym_spec.dpa.getMaxColor() + 1){
     // reserve some space in the vector to avoid initial resizing, which needs locking for the parallel construction
     sys_succs_begin.reserve(RESERVE);
     sys_succs.reserve(RESERVE);
+    sys_output_begin.reserve(RESERVE);
+    sys_output_encoding.reserve(RESERVE);
     sys_output.reserve(RESERVE);
     env_succs_begin.reserve(RESERVE);
     env_succs.reserve(RESERVE);
+    env_input_begin.reserve(RESERVE);
     env_input.reserve(RESERVE);
     env_node_map.reserve(RESERVE);
     env_node_reachable.reserve(RESERVE);
@@ -145,15 +379,98 @@ parity(_sym_spec.dpa.getParity()), n_colors(_sym_spec.dpa.getMaxColor() + 1){
     // initialize the nodes/edges
     sys_succs_begin.push_back(0);
     env_succs_begin.push_back(0);
+    sys_output_begin.push_back(0);
+    env_input_begin.push_back(0);
 }
 
 template<class T, class L1, class L2>
 PGame<T, L1, L2>::~PGame() {
 }
 
+template<class T, class L1, class L2>
+void PGame<T, L1, L2>::groupControls(){
+
+    // the DPA successor only depends on the letter L_x(x) | L_u(u) << n, so the controls
+    // having the same L_u mask lead to the same DPA successor from the same (q, x)
+    std::unordered_map<strix_aut::letter_t, uint32_t> clause_to_class;
+    control_class_clauses.clear();
+    control_class.resize(sym_model.get_n_controls());
+    for (symbolic_t sym_control = 0; sym_control < sym_model.get_n_controls(); sym_control++){
+        const strix_aut::letter_t clause = sym_spec.get_control_clause(sym_control);
+        auto const result = clause_to_class.insert({ clause, (uint32_t)control_class_clauses.size() });
+        if (result.second)
+            control_class_clauses.push_back(clause);
+        control_class[sym_control] = result.first->second;
+    }
+}
+
+template<class T, class L1, class L2>
+void PGame<T, L1, L2>::stepControlClasses(const symbolic_t dpa_state, const SymState& sym_state, std::vector<ControlClassStep>& steps) const {
+
+    const strix_aut::letter_t state_clause = sym_spec.get_state_clause(sym_state);
+
+    steps.resize(control_class_clauses.size());
+    for (size_t c = 0; c < control_class_clauses.size(); c++){
+        ControlClassStep& step = steps[c];
+        const size_t letter_slot = sym_spec.dpa.getLetterSlot(state_clause | control_class_clauses[c]);
+        const DpaTransition transition = sym_spec.dpa.getTransition(dpa_state, letter_slot);
+        step.dpa_state = transition.successor_idx;
+        step.color = transition.color;
+        step.is_bottom = sym_spec.dpa.isBottomState(step.dpa_state);
+        step.is_top = !step.is_bottom && sym_spec.dpa.isTopState(step.dpa_state);
+    }
+}
+
 template<class T, class L1, class L2>
 void PGame<T, L1, L2>::constructArena(){
 
+    // group the controls by their control APs
+    groupControls();
+
+    // the env states are looked up by keys packed from (q, x, u). the tables of the
+    // keys are pre-sized with |Q|.|X|.|U| (dummy/overflow states included) but not
+    // more than what we anyway reserve for the arena. for lazy DPAs, |Q| is not known
+    // yet and the bound of the DPA is used
+    const size_t n_dpa_states = sym_spec.dpa.getStatesBound();
+    const size_t n_sym_states = sym_model.get_n_states() + 2;
+    const size_t n_sym_controls = sym_model.get_n_controls();
+    EnvStateKeyPacker packer(n_dpa_states, sym_model.get_n_states(), n_sym_controls);
+
+    size_t expected_states = RESERVE;
+    if ((double)n_dpa_states * (double)n_sym_states * (double)n_sym_controls < (double)RESERVE)
+        expected_states = n_dpa_states * n_sym_states * n_sym_controls;
+
+    // a lazy DPA queries OWL while the arena is constructed, which can only be done
+    // from the thread owning the OWL isolate
+    if(parallel_construction && sym_spec.dpa.getStorage() != DpaStorage::LAZY){
+        if(packer.fits_64())
+            constructArenaParallel<uint64_t>(packer, expected_states);
+        else
+            constructArenaParallel<EnvStateKey128>(packer, expected_states);
+    }
+    else {
+        if(packer.fits_64())
+            constructArenaSerial<uint64_t>(packer, expected_states);
+        else
+            constructArenaSerial<EnvStateKey128>(packer, expected_states);
+    }
+
+    // some tests
+    assert(n_sys_nodes + 1 == sys_succs_begin.size());
+    assert(n_env_nodes + 1 == env_succs_begin.size());
+    assert(n_sys_nodes == sys_winner.size());
+    assert(n_env_nodes == env_winner.size());
+    assert(n_sys_edges == sys_succs.size());
+    assert(n_env_edges == env_succs.size());  
+
+    // mark as completed
+    complete = true;
+}
+
+template<class T, class L1, class L2>
+template<class K>
+void PGame<T, L1, L2>::constructArenaSerial(const EnvStateKeyPacker& packer, size_t expected_states){
+
     // get initial state of the Spec-DPA-tree
     symbolic_t dpa_initial_state = sym_spec.dpa.getInitialState();
 
@@ -161,8 +478,12 @@ void PGame<T, L1, L2>::constructArena(){
     std::vector<env_state_t> states;
     states.reserve(RESERVE);
 
-    // map from product states in queue to scores and reference ids
-    std::unordered_map<env_state_t, ScoredProductState, container_hash<env_state_t> > state_map;  
+    // map from (packed) product states to reference ids
+    FlatStateTable<K> state_map(expected_states);
+    K key;
+
+    // the DPA steps of the control classes
+    std::vector<ControlClassStep> class_steps;
 
     // queues for new states
     state_queue queue_new_states;
@@ -173,7 +494,8 @@ void PGame<T, L1, L2>::constructArena(){
         const size_t end = sys_succs_begin[sys_node + 1];
         size_t seed = 0;
         boost::hash_range(seed, sys_succs.cbegin() + begin, sys_succs.cbegin() + end);
-        boost::hash_range(seed, sys_output.cbegin() + begin, sys_output.cbegin() + end);
+        boost::hash_range(seed, sys_output_encoding.cbegin() + begin, sys_output_encoding.cbegin() + end);
+        boost::hash_range(seed, sys_output.cbegin() + sys_output_begin[begin], sys_output.cbegin() + sys_output_begin[end]);
         return seed;
     };
     auto sys_node_equal = [this](const strix_aut::node_id_t sys_node_1, const strix_aut::node_id_t sys_node_2) {
@@ -189,7 +511,7 @@ void PGame<T, L1, L2>::constructArena(){
             for (size_t j = 0; j < length1; j++) {
                 if (
                         (sys_succs[begin1 + j] != sys_succs[begin2 + j]) ||
-                        (sys_output[begin1 + j] != sys_output[begin2 + j])
+                        (getSysOutput(begin1 + j) != getSysOutput(begin2 + j))
                 ) {
                     result = false;
                     break;
@@ -220,7 +542,8 @@ void PGame<T, L1, L2>::constructArena(){
     env_node_map.push_back(strix_aut::NODE_NONE);
     env_node_reachable.push_back(true);  
     ScoredProductState initial(1.0, initial_node_ref);
-    state_map.insert({ std::make_tuple(dpa_initial_state, sym_model.get_dummy_state(), 0), ScoredProductState(initial) });
+    packer.pack(dpa_initial_state, sym_model.get_dummy_state(), 0, key);
+    state_map.insert(key, [&]() { return initial_node_ref; });
     queue_new_states.push(initial);
     env_state_t initial_node_state = std::make_tuple(std::move(dpa_initial_state), sym_model.get_dummy_state(), 0);
     states.push_back(initial_node_state);              
@@ -259,10 +582,12 @@ void PGame<T, L1, L2>::constructArena(){
             symbolic_t sym_model_state = std::get<1>(states[ref_id]).value;
             symbolic_t sym_control_inp = std::get<2>(states[ref_id]);
 
-            std::vector<SymState> mdl_posts = sym_model.get_posts(sym_model.construct_state(sym_model_state), sym_control_inp);
-            for (SymState mdl_post : mdl_posts){
+            if(sym_model.is_posts_cache_enabled())
+                sym_model.prepare_posts({ std::make_pair(sym_model_state, sym_control_inp) });
+
+            sym_model.for_each_post(sym_model.construct_state(sym_model_state), sym_control_inp, [&](const SymState& mdl_post){
                 env_sym_states.push_back(mdl_post.value);
-            }
+            });
         }
 
         // for all inputs (env edges): symbolic states
@@ -276,20 +601,20 @@ void PGame<T, L1, L2>::constructArena(){
             std::map<GameEdge, std::vector<symbolic_t>> sys_successors;
             strix_aut::edge_id_t cur_sys_node_n_sys_edges = 0;
 
+            // the DPA steps of all control classes (done once per class, not per control)
+            stepControlClasses(std::get<0>(states[ref_id]), current_sym_state, class_steps);
+
             // for all outputs (system edges): the controls
             for (symbolic_t sym_control = 0; sym_control < sym_model.get_n_controls(); sym_control++){
 
-                // now er can compute joint letter for automata lookup
-                strix_aut::letter_t letter = sym_spec.get_complete_clause(current_sym_state, sym_control);
+                // the DPA step of the class of this control
+                const ControlClassStep& step = class_steps[control_class[sym_control]];
 
                 // a var for the new state (yes it is only one as this is a *D*PA )
-                symbolic_t new_dpa_state;
-
-                // get the next state (store in new_dpa_state)
-                const strix_aut::ColorScore cs = sym_spec.dpa.getSuccessor(std::get<0>(states[ref_id]), new_dpa_state, letter);         
+                symbolic_t new_dpa_state = step.dpa_state;
 
                 // get the color of this transition
-                const strix_aut::color_t color = cs.color;                               
+                const strix_aut::color_t color = step.color;                               
 
                 // score
                 double score = -(double)(env_node_map.size());
@@ -298,17 +623,18 @@ void PGame<T, L1, L2>::constructArena(){
                 strix_aut::node_id_t succ = env_node_map.size();
 
                 // skip buttom states
-                if (!sym_spec.dpa.isBottomState(new_dpa_state)) {
+                if (!step.is_bottom) {
 
                     // is it top ?
-                    if (sym_spec.dpa.isTopState(new_dpa_state)) {
+                    if (step.is_top) {
                         succ = top_node_ref;
                     }
                     // now: it is not top or buttom
                     else {
-                        auto result = state_map.insert({ std::make_tuple(new_dpa_state,current_sym_state, sym_control), ScoredProductState(score, succ) });
+                        packer.pack(new_dpa_state, current_sym_state, sym_control, key);
+                        auto result = state_map.insert(key, [succ]() { return succ; });
 
-                        // is it new there ? (we use the result from the insert on the unordered_map state_map)
+                        // is it new there ? (we use the result from the insert on the table state_map)
                         if (result.second){
                             env_node_map.push_back(strix_aut::NODE_NONE);
                             env_node_reachable.push_back(true);
@@ -320,7 +646,7 @@ void PGame<T, L1, L2>::constructArena(){
                         }
                         else {
                             // change ???
-                            succ = result.first->second.ref_id;
+                            succ = result.first;
                         }
                     }    
 
@@ -342,7 +668,8 @@ void PGame<T, L1, L2>::constructArena(){
 
             for (const auto& it : sys_successors) {
                 sys_succs.push_back(it.first);
-                sys_output.push_back(it.second);
+                sys_output_encoding.push_back(ControlSet::encode(it.second, sys_output));
+                sys_output_begin.push_back(sys_output.size());
             }
             sys_succs_begin.push_back(sys_succs.size());
             sys_winner.push_back(strix_aut::Player::UNKNOWN_PLAYER);                
@@ -355,7 +682,9 @@ void PGame<T, L1, L2>::constructArena(){
             else {
                 // sys node already present
                 sys_succs.resize(sys_succs.size() - cur_sys_node_n_sys_edges);
-                sys_output.resize(sys_output.size() - cur_sys_node_n_sys_edges);
+                sys_output_begin.resize(sys_output_begin.size() - cur_sys_node_n_sys_edges);
+                sys_output_encoding.resize(sys_output_encoding.size() - cur_sys_node_n_sys_edges);
+                sys_output.resize(sys_output_begin.back());
                 sys_succs_begin.resize(sys_succs_begin.size() - 1);
                 sys_winner.resize(sys_winner.size() - 1);
                 cur_sys_node_n_sys_edges = 0;
@@ -374,7 +703,8 @@ void PGame<T, L1, L2>::constructArena(){
         n_env_edges += env_successors.size();
         for (const auto& it : env_successors) {
             env_succs.push_back(it.first);
-            env_input.push_back(it.second);
+            env_input.insert(env_input.end(), it.second.cbegin(), it.second.cend());
+            env_input_begin.push_back(env_input.size());
         }
         env_succs_begin.push_back(env_succs.size());
         env_winner.push_back(strix_aut::Player::UNKNOWN_PLAYER);
@@ -386,17 +716,273 @@ void PGame<T, L1, L2>::constructArena(){
         //print_info();
         //std::cout << "------------------------------\n";
     }
+}
 
-    // some tests
-    assert(n_sys_nodes + 1 == sys_succs_begin.size());
-    assert(n_env_nodes + 1 == env_succs_begin.size());
-    assert(n_sys_nodes == sys_winner.size());
-    assert(n_env_nodes == env_winner.size());
-    assert(n_sys_edges == sys_succs.size());
-    assert(n_env_edges == env_succs.size());  
+// the parallel construction follows the serial one step by step: the serial queue hands out 
+// the env nodes in the order of their ref ids, so the nodes are here explored in batches of
+// consecutive ref ids. each batch goes through four phases:
+//  (1) parallel: compute the posts and DPA successors of the nodes and get provisional ids of 
+//      the successor env states from a concurrent state map,
+//  (2) serial: renumber the new provisional ids to ref ids in the order the serial exploration 
+//      would have discovered them,
+//  (3) parallel: sort the transitions of each sys node as the serial std::map would do,
+//  (4) serial: append the sys/env nodes and edges to the arena (with the sys-node cache).
+// this way, the resulting arena is identical to the one of the serial construction.
+template<class T, class L1, class L2>
+template<class K>
+void PGame<T, L1, L2>::constructArenaParallel(const EnvStateKeyPacker& packer, size_t expected_states){
 
-    // mark as completed
-    complete = true;
+    const size_t n_threads = (construction_threads > 0 ? construction_threads : std::max<size_t>(1, std::thread::hardware_concurrency()));
+    const symbolic_t n_controls = sym_model.get_n_controls();
+
+    // get initial state of the Spec-DPA-tree
+    symbolic_t dpa_initial_state = sym_spec.dpa.getInitialState();
+
+    // the states
+    std::vector<env_state_t> states;
+    states.reserve(RESERVE);
+
+    // map from product states to provisional ids + the ref ids of the provisional ids
+    ConcurrentStateMap<K> state_map(expected_states);
+    std::vector<strix_aut::node_id_t> provisional_refs;
+
+    // cache for system nodes
+    auto sys_node_hash = [this](const strix_aut::node_id_t sys_node) {
+        const size_t begin = sys_succs_begin[sys_node];
+        const size_t end = sys_succs_begin[sys_node + 1];
+        size_t seed = 0;
+        boost::hash_range(seed, sys_succs.cbegin() + begin, sys_succs.cbegin() + end);
+        boost::hash_range(seed, sys_output_encoding.cbegin() + begin, sys_output_encoding.cbegin() + end);
+        boost::hash_range(seed, sys_output.cbegin() + sys_output_begin[begin], sys_output.cbegin() + sys_output_begin[end]);
+        return seed;
+    };
+    auto sys_node_equal = [this](const strix_aut::node_id_t sys_node_1, const strix_aut::node_id_t sys_node_2) {
+        const size_t begin1 = sys_succs_begin[sys_node_1];
+        const size_t length1 = sys_succs_begin[sys_node_1 + 1] - begin1;
+        const size_t begin2 = sys_succs_begin[sys_node_2];
+        const size_t length2 = sys_succs_begin[sys_node_2 + 1] - begin2;
+        if (length1 != length2) {
+            return false;
+        }
+        else {
+            for (size_t j = 0; j < length1; j++) {
+                if (
+                        (sys_succs[begin1 + j] != sys_succs[begin2 + j]) ||
+                        (getSysOutput(begin1 + j) != getSysOutput(begin2 + j))
+                ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+    auto sys_node_map = std::unordered_set<strix_aut::node_id_t, decltype(sys_node_hash), decltype(sys_node_equal)>(RESERVE, sys_node_hash, sys_node_equal);  
+
+    // add ref for top node
+    const strix_aut::node_id_t top_node_ref = env_node_map.size();
+    env_node_map.push_back(strix_aut::NODE_TOP);
+    env_node_reachable.push_back(true);
+    states.push_back(std::make_tuple(-1, sym_model.get_dummy_state(), 0));
+
+    // add the initial state
+    initial_node_ref = env_node_map.size();
+    env_node_map.push_back(strix_aut::NODE_NONE);
+    env_node_reachable.push_back(true);
+    env_state_t initial_node_state = std::make_tuple(dpa_initial_state, sym_model.get_dummy_state(), 0);
+    K initial_key;
+    packer.pack(dpa_initial_state, sym_model.get_dummy_state(), 0, initial_key);
+    state_map.insert(initial_key);
+    provisional_refs.push_back(initial_node_ref);
+    states.push_back(initial_node_state);
+
+    // a transition found while exploring an env node
+    struct ExploredTransition {
+        strix_aut::node_id_t target;    // provisional id (phase 1) then ref id (phase 2)
+        strix_aut::color_t color;
+        symbolic_t control;
+        symbolic_t dpa_state;
+    };
+
+    // the result of exploring an env node: its inputs (posts) and, per input, the transitions
+    struct ExploredNode {
+        std::vector<symbolic_t> inputs;
+        std::vector<size_t> inputs_end;
+        std::vector<ExploredTransition> transitions;
+    };
+    std::vector<ExploredNode> batch(PARALLEL_BATCH);
+
+    // the exploration loop: keep exploring batches of env nodes till no more new states
+    strix_aut::node_id_t batch_begin = initial_node_ref;
+    while (batch_begin < states.size()) {
+        const strix_aut::node_id_t batch_end = std::min<strix_aut::node_id_t>(states.size(), batch_begin + PARALLEL_BATCH);
+        const size_t batch_size = batch_end - batch_begin;
+
+        // phase 0: the posts of the (x,u) pairs of the batch are computed together (if cached)
+        if (sym_model.is_posts_cache_enabled()) {
+            std::vector<std::pair<symbolic_t, symbolic_t>> batch_state_controls;
+            batch_state_controls.reserve(batch_size);
+            for (size_t i = 0; i < batch_size; i++) {
+                const env_state_t& state = states[batch_begin + i];
+                if (!sym_model.is_dummy_state(std::get<1>(state)) && !sym_model.is_overflow_state(std::get<1>(state)))
+                    batch_state_controls.push_back(std::make_pair(std::get<1>(state).value, std::get<2>(state)));
+            }
+            sym_model.prepare_posts(batch_state_controls);
+        }
+
+        // phase 1: explore the env nodes of the batch
+        work_stealing_for(batch_size, n_threads, 8, [&](size_t start, size_t end) {
+            std::vector<ControlClassStep> class_steps;
+            for (size_t i = start; i < end; i++) {
+                const env_state_t& state = states[batch_begin + i];
+                ExploredNode& node = batch[i];
+                node.inputs.clear();
+                node.inputs_end.clear();
+                node.transitions.clear();
+
+                // collect next model states to be used for making the env edges
+                if(sym_model.is_dummy_state(std::get<1>(state))){
+                    for (const SymState& initial_state : sym_model.get_initial_states())
+                        node.inputs.push_back(initial_state.value);
+                }
+                else {
+                    sym_model.for_each_post(std::get<1>(state), std::get<2>(state), [&](const SymState& mdl_post){
+                        node.inputs.push_back(mdl_post.value);
+                    });
+                }
+
+                // for all inputs: all controls (with the DPA steps done once per control class)
+                for (symbolic_t sym_state : node.inputs){
+                    SymState current_sym_state = sym_model.construct_state(sym_state);
+                    stepControlClasses(std::get<0>(state), current_sym_state, class_steps);
+
+                    for (symbolic_t sym_control = 0; sym_control < n_controls; sym_control++){
+                        const ControlClassStep& step = class_steps[control_class[sym_control]];
+
+                        // skip buttom states
+                        if (step.is_bottom)
+                            continue;
+
+                        strix_aut::node_id_t target = strix_aut::NODE_TOP;
+                        if (!step.is_top) {
+                            K key;
+                            packer.pack(step.dpa_state, current_sym_state, sym_control, key);
+                            target = state_map.insert(key).first;
+                        }
+
+                        node.transitions.push_back({ target, step.color, sym_control, step.dpa_state });
+                    }
+                    node.inputs_end.push_back(node.transitions.size());
+                }
+            }
+        });
+
+        // phase 2: give the new states their ref ids in the order of discovery
+        provisional_refs.resize(state_map.size(), strix_aut::NODE_NONE);
+        for (size_t i = 0; i < batch_size; i++) {
+            ExploredNode& node = batch[i];
+            size_t t = 0;
+            for (size_t j = 0; j < node.inputs.size(); j++) {
+                for (; t < node.inputs_end[j]; t++) {
+                    ExploredTransition& transition = node.transitions[t];
+                    if (transition.target == strix_aut::NODE_TOP) {
+                        transition.target = top_node_ref;
+                        continue;
+                    }
+
+                    strix_aut::node_id_t& ref = provisional_refs[transition.target];
+                    if (ref == strix_aut::NODE_NONE) {
+                        ref = env_node_map.size();
+                        env_node_map.push_back(strix_aut::NODE_NONE);
+                        env_node_reachable.push_back(true);
+                        states.push_back(std::make_tuple(transition.dpa_state, sym_model.construct_state(node.inputs[j]), transition.control));
+                    }
+                    transition.target = ref;
+                }
+            }
+        }
+
+        // phase 3: order the transitions of each sys node by (successor, color, control)
+        work_stealing_for(batch_size, n_threads, 8, [&](size_t start, size_t end) {
+            for (size_t i = start; i < end; i++) {
+                ExploredNode& node = batch[i];
+                size_t begin = 0;
+                for (size_t j = 0; j < node.inputs.size(); j++) {
+                    std::sort(node.transitions.begin() + begin, node.transitions.begin() + node.inputs_end[j],
+                        [](const ExploredTransition& t1, const ExploredTransition& t2) {
+                            return std::tie(t1.target, t1.color, t1.control) < std::tie(t2.target, t2.color, t2.control);
+                        });
+                    begin = node.inputs_end[j];
+                }
+            }
+        });
+
+        // phase 4: add the nodes and edges to the arena
+        std::vector<symbolic_t> controls;
+        for (size_t i = 0; i < batch_size; i++) {
+            const ExploredNode& node = batch[i];
+            env_node_map[batch_begin + i] = n_env_nodes;
+
+            strix_aut::edge_id_t cur_env_node_n_sys_edges = 0;
+            strix_aut::node_id_t cur_n_sys_nodes = 0;
+            std::map<strix_aut::node_id_t, std::vector<symbolic_t>> env_successors;
+
+            size_t t = 0;
+            for (size_t j = 0; j < node.inputs.size(); j++) {
+                strix_aut::node_id_t sys_node = n_sys_nodes + cur_n_sys_nodes;
+                strix_aut::edge_id_t cur_sys_node_n_sys_edges = 0;
+
+                while (t < node.inputs_end[j]) {
+                    const ExploredTransition& first = node.transitions[t];
+                    sys_succs.push_back(GameEdge(first.target, first.color));
+                    controls.clear();
+                    for (; t < node.inputs_end[j] && node.transitions[t].target == first.target && node.transitions[t].color == first.color; t++)
+                        controls.push_back(node.transitions[t].control);
+                    sys_output_encoding.push_back(ControlSet::encode(controls, sys_output));
+                    sys_output_begin.push_back(sys_output.size());
+                    cur_sys_node_n_sys_edges++;
+                }
+                sys_succs_begin.push_back(sys_succs.size());
+                sys_winner.push_back(strix_aut::Player::UNKNOWN_PLAYER);
+
+                auto const result = sys_node_map.insert(sys_node);
+                if (result.second) {
+                    cur_n_sys_nodes++;
+                }
+                else {
+                    sys_succs.resize(sys_succs.size() - cur_sys_node_n_sys_edges);
+                    sys_output_begin.resize(sys_output_begin.size() - cur_sys_node_n_sys_edges);
+                    sys_output_encoding.resize(sys_output_encoding.size() - cur_sys_node_n_sys_edges);
+                    sys_output.resize(sys_output_begin.back());
+                    sys_succs_begin.resize(sys_succs_begin.size() - 1);
+                    sys_winner.resize(sys_winner.size() - 1);
+                    cur_sys_node_n_sys_edges = 0;
+                    sys_node = *result.first;
+                }
+
+                auto const result2 = env_successors.insert({ sys_node, {node.inputs[j]} });
+                if (!result2.second) {
+                    result2.first->second.push_back(node.inputs[j]);
+                }
+
+                cur_env_node_n_sys_edges += cur_sys_node_n_sys_edges;
+            }
+
+            n_env_edges += env_successors.size();
+            for (const auto& it : env_successors) {
+                env_succs.push_back(it.first);
+                env_input.insert(env_input.end(), it.second.cbegin(), it.second.cend());
+                env_input_begin.push_back(env_input.size());
+            }
+            env_succs_begin.push_back(env_succs.size());
+            env_winner.push_back(strix_aut::Player::UNKNOWN_PLAYER);
+
+            n_sys_edges += cur_env_node_n_sys_edges;
+            n_sys_nodes += cur_n_sys_nodes;
+            n_env_nodes++;
+        }
+
+        batch_begin = batch_end;
+    }
 }
 
 template<class T, class L1, class L2>
@@ -469,8 +1055,8 @@ GameEdge PGame<T, L1, L2>::getSysEdge(strix_aut::edge_id_t sys_edge) const {
 }
 
 template<class T, class L1, class L2>
-std::vector<symbolic_t> PGame<T, L1, L2>::getSysOutput(strix_aut::edge_id_t sys_edge) const { 
-    return sys_output[sys_edge]; 
+ControlSet PGame<T, L1, L2>::getSysOutput(strix_aut::edge_id_t sys_edge) const { 
+    return ControlSet(sys_output_encoding[sys_edge], sys_output.data() + sys_output_begin[sys_edge], sys_output.data() + sys_output_begin[sys_edge + 1]); 
 }
 
 template<class T, class L1, class L2>
@@ -489,8 +1075,8 @@ strix_aut::node_id_t PGame<T, L1, L2>::getEnvEdge(strix_aut::edge_id_t env_edge)
 }
 
 template<class T, class L1, class L2>
-std::vector<symbolic_t> PGame<T, L1, L2>::getEnvInput(strix_aut::edge_id_t env_edge) const {
-    return env_input[env_edge]; 
+SymbolSpan PGame<T, L1, L2>::getEnvInput(strix_aut::edge_id_t env_edge) const {
+    return SymbolSpan(env_input.data() + env_input_begin[env_edge], env_input.data() + env_input_begin[env_edge + 1]); 
 }
 
 /* force the compiler to implement the class for needed function types */
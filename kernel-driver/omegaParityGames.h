@@ -12,6 +12,9 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <bitset>
+#include <iterator>
+#include <algorithm>
 
 #include <Ltl2Dpa.h>
 #include <pfaces-sdk.h>
@@ -19,6 +22,9 @@
 
 namespace pFacesOmegaKernels{
 
+// packs the env states of the game in flat keys (see omegaParityGames.cpp)
+class EnvStateKeyPacker;
+
 // a class representing the edge in a parity game structure
 class GameEdge {
 public:
@@ -34,6 +40,158 @@ public:
 };
 
 
+// a read-only view on a contiguous range of symbols in a flat (CSR) array. 
+// it is used to access the outputs/inputs of game edges without copying them
+class SymbolSpan {
+    const symbolic_t* first;
+    const symbolic_t* last;
+
+public:
+    SymbolSpan():first(nullptr), last(nullptr){}
+    SymbolSpan(const symbolic_t* _first, const symbolic_t* _last):first(_first), last(_last){}
+
+    const symbolic_t* begin() const { return first; }
+    const symbolic_t* end() const { return last; }
+    size_t size() const { return (size_t)(last - first); }
+    bool empty() const { return first == last; }
+    symbolic_t operator[](size_t i) const { return first[i]; }
+
+    bool operator==(const SymbolSpan& other) const {
+        return (size() == other.size()) && std::equal(first, last, other.first);
+    }
+    bool operator!=(const SymbolSpan& other) const {
+        return !(*this == other);
+    }
+};
+
+
+// a compact encoding of a set of control symbols (e.g., the outputs of a sys edge) stored
+// as 64-bit words in a flat array. a set is encoded with the one needing less words of:
+//  - LIST      : the symbols in increasing order,
+//  - INTERVALS : the first/last symbols of the runs of consecutive symbols,
+//  - BITSET    : the index of the first non-empty 64-bit block of U followed by the blocks 
+//                till the last non-empty one.
+// the encoding of a set is unique, so two sets are equal iff their encodings are equal
+class ControlSet {
+public:
+    enum ENCODING : uint8_t {
+        LIST,
+        INTERVALS,
+        BITSET
+    };
+
+    // iterates the symbols of the set in increasing order
+    class const_iterator {
+        ENCODING encoding;
+        const uint64_t* word;
+        const uint64_t* last;
+        uint64_t current;   // LIST: unused, INTERVALS: current symbol, BITSET: remaining bits of *word
+        uint64_t base;      // BITSET: the symbol of bit 0 of *word
+
+        static size_t count_trailing_zeros(const uint64_t bits) {
+            return std::bitset<64>((bits & (~bits + 1)) - 1).count();
+        }
+
+        void skip_empty_blocks() {
+            while (current == 0 && ++word != last) {
+                current = *word;
+                base += 64;
+            }
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef symbolic_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const symbolic_t* pointer;
+        typedef symbolic_t reference;
+
+        const_iterator(ENCODING _encoding, const uint64_t* first, const uint64_t* _last)
+        :encoding(_encoding), word(first), last(_last), current(0), base(0){
+            if (word == last)
+                return;
+            if (encoding == INTERVALS) {
+                current = word[0];
+            }
+            else if (encoding == BITSET) {
+                base = word[0] * 64;
+                if (++word != last) {
+                    current = *word;
+                    skip_empty_blocks();
+                }
+            }
+        }
+
+        symbolic_t operator*() const {
+            if (encoding == LIST)
+                return (symbolic_t)*word;
+            else if (encoding == INTERVALS)
+                return (symbolic_t)current;
+            else
+                return (symbolic_t)(base + count_trailing_zeros(current));
+        }
+
+        const_iterator& operator++() {
+            if (encoding == LIST) {
+                word++;
+            }
+            else if (encoding == INTERVALS) {
+                if (current == word[1]) {
+                    word += 2;
+                    current = (word != last ? word[0] : 0);
+                }
+                else {
+                    current++;
+                }
+            }
+            else {
+                current &= current - 1;
+                skip_empty_blocks();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return (word == other.word) && (current == other.current);
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+private:
+    ENCODING encoding;
+    const uint64_t* first;
+    const uint64_t* last;
+
+public:
+    ControlSet():encoding(LIST), first(nullptr), last(nullptr){}
+    ControlSet(ENCODING _encoding, const uint64_t* _first, const uint64_t* _last):encoding(_encoding), first(_first), last(_last){}
+
+    // encodes a set of symbols given in increasing order by appending its words to (words)
+    static ENCODING encode(const std::vector<symbolic_t>& symbols, std::vector<uint64_t>& words);
+
+    const_iterator begin() const { return const_iterator(encoding, first, last); }
+    const_iterator end() const { return const_iterator(encoding, last, last); }
+    size_t size() const;
+    bool empty() const { return first == last; }
+    ENCODING get_encoding() const { return encoding; }
+
+    bool operator==(const ControlSet& other) const {
+        return (encoding == other.encoding) && ((last - first) == (other.last - other.first)) && std::equal(first, last, other.first);
+    }
+    bool operator!=(const ControlSet& other) const {
+        return !(*this == other);
+    }
+};
+
+
 // a class combining a product-state-reference and a score
 class ScoredProductState {
 public:
@@ -52,6 +210,9 @@ class PGame{
     // a suitable number for reserving initial items in the vectors
     static constexpr size_t RESERVE = 4194304;    
 
+    // number of env nodes explored together in one batch of the parallel construction
+    static constexpr size_t PARALLEL_BATCH = 1024;
+
     // a link to the DPA-tree-struct
     SymSpec<L1,L2>& sym_spec;
     SymModel<T>& sym_model;
@@ -67,8 +228,11 @@ class PGame{
     std::vector<strix_aut::edge_id_t> env_succs_begin;
     std::vector<GameEdge> sys_succs;
     std::vector<strix_aut::node_id_t> env_succs;
-    std::vector<std::vector<symbolic_t>> sys_output;
-    std::vector<std::vector<symbolic_t>> env_input;
+    std::vector<size_t> sys_output_begin;   // CSR: words of the outputs of sys edge i are at [sys_output_begin[i], sys_output_begin[i+1])
+    std::vector<ControlSet::ENCODING> sys_output_encoding;
+    std::vector<uint64_t> sys_output;
+    std::vector<size_t> env_input_begin;    // CSR: inputs of env edge i are at [env_input_begin[i], env_input_begin[i+1])
+    std::vector<symbolic_t> env_input;
     std::vector<strix_aut::node_id_t> env_node_map;
     std::vector<bool> env_node_reachable;
     
@@ -77,6 +241,30 @@ class PGame{
     std::vector<strix_aut::Player> sys_winner;
     std::vector<strix_aut::Player> env_winner;
 
+    // construction settings
+    bool parallel_construction;
+    size_t construction_threads;
+
+    // the DPA step taken by a class of controls (i.e., controls having the same control-AP clause)
+    struct ControlClassStep {
+        symbolic_t dpa_state;
+        strix_aut::color_t color;
+        bool is_bottom;
+        bool is_top;
+    };
+
+    // the controls grouped in classes by their control-AP clauses
+    std::vector<strix_aut::letter_t> control_class_clauses;
+    std::vector<uint32_t> control_class;
+
+    void groupControls();
+    void stepControlClasses(const symbolic_t dpa_state, const SymState& sym_state, std::vector<ControlClassStep>& steps) const;
+
+    template<class K>
+    void constructArenaSerial(const EnvStateKeyPacker& packer, size_t expected_states);
+    template<class K>
+    void constructArenaParallel(const EnvStateKeyPacker& packer, size_t expected_states);
+
 public:
     size_t n_inputs;             // number of input vars
     size_t n_outputs;            // number of output vars
@@ -84,7 +272,7 @@ public:
     strix_aut::Parity parity;    // parity of the game
     strix_aut::color_t n_colors; // number of colors
 
-    PGame(SymSpec<L1, L2>& _sym_spec, SymModel<T>& _sym_model);
+    PGame(SymSpec<L1, L2>& _sym_spec, SymModel<T>& _sym_model, bool _parallel_construction = false, size_t _construction_threads = 0);
     ~PGame();
 
     void constructArena();
@@ -104,11 +292,11 @@ public:
     strix_aut::edge_id_t getSysSuccsBegin(strix_aut::node_id_t sys_node) const;
     strix_aut::edge_id_t getSysSuccsEnd(strix_aut::node_id_t sys_node) const;
     GameEdge getSysEdge(strix_aut::edge_id_t sys_edge) const;
-    std::vector<symbolic_t> getSysOutput(strix_aut::edge_id_t sys_edge) const;
+    ControlSet getSysOutput(strix_aut::edge_id_t sys_edge) const;
     strix_aut::edge_id_t getEnvSuccsBegin(strix_aut::node_id_t env_node) const;
     strix_aut::edge_id_t getEnvSuccsEnd(strix_aut::node_id_t env_node) const;
     strix_aut::node_id_t getEnvEdge(strix_aut::edge_id_t env_edge) const;
-    std::vector<symbolic_t> getEnvInput(strix_aut::edge_id_t env_edge) const;
+    SymbolSpan getEnvInput(strix_aut::edge_id_t env_edge) const;
 
 };
 
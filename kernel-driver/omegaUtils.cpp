@@ -1,5 +1,24 @@
 #include "omega.h"
 
+#include <iomanip>
+#include <cstdio>
+#include <chrono>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace pFacesOmegaKernels{
 
     std::vector<hyperrect> OmegaUtils::extractHyperrects(const std::string& hyperrects_line, size_t dim){
@@ -182,6 +201,37 @@ namespace pFacesOmegaKernels{
         return ret;
     }
 
+    std::string OmegaUtils::HashKey(const std::string& text){
+        uint64_t hash = 14695981039346656037ULL;
+        for(const char c : text){
+            hash ^= (uint8_t)c;
+            hash *= 1099511628211ULL;
+        }
+
+        std::stringstream key;
+        key << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return key.str();
+    }
+
+    bool OmegaUtils::WriteCacheFile(const std::string& cache_file, const std::function<void(const std::string&)>& write){
+        const std::string tmp_file = cache_file + std::string(".") + 
+            std::to_string(std::chrono::high_resolution_clock::now().time_since_epoch().count()) + std::string(".tmp");
+
+        bool written = true;
+        try {
+            write(tmp_file);
+        }
+        catch(const std::exception&){
+            written = false;
+        }
+
+        if(!written || std::rename(tmp_file.c_str(), cache_file.c_str()) != 0){
+            std::remove(tmp_file.c_str());
+            return pfacesFileIO::isFileExist(cache_file);
+        }
+        return true;
+    }
+
 
     // override istream to use if fot reading an OWL enum type for statuses from files
     std::istream& operator >> (std::istream& i, atomic_proposition_status_t& status){
@@ -240,4 +290,67 @@ namespace pFacesOmegaKernels{
     template void OmegaUtils::scan_vector(std::vector<uint64_t>& vec, std::istream& ist);
     template void OmegaUtils::scan_vector(std::vector<int64_t>& vec, std::istream& ist);
     template void OmegaUtils::scan_vector(std::vector<atomic_proposition_status_t>& vec, std::istream& ist);
-}
\ No newline at end of file
+
+
+    MappedFile::MappedFile(const std::string& filename):mapped_data(nullptr), mapped_size(0){
+#ifdef _WIN32
+        file_handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(file_handle == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("MappedFile::MappedFile: could not open the file: " + filename);
+
+        LARGE_INTEGER file_size;
+        if(!GetFileSizeEx(file_handle, &file_size)){
+            CloseHandle(file_handle);
+            throw std::runtime_error("MappedFile::MappedFile: could not get the size of the file: " + filename);
+        }
+        mapped_size = (size_t)file_size.QuadPart;
+
+        mapping_handle = NULL;
+        if(mapped_size > 0){
+            mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+            if(mapping_handle != NULL)
+                mapped_data = (const char*)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+            if(mapped_data == nullptr){
+                if(mapping_handle != NULL)
+                    CloseHandle(mapping_handle);
+                CloseHandle(file_handle);
+                throw std::runtime_error("MappedFile::MappedFile: could not map the file: " + filename);
+            }
+        }
+#else
+        file_descriptor = open(filename.c_str(), O_RDONLY);
+        if(file_descriptor < 0)
+            throw std::runtime_error("MappedFile::MappedFile: could not open the file: " + filename);
+
+        struct stat file_stat;
+        if(fstat(file_descriptor, &file_stat) != 0){
+            close(file_descriptor);
+            throw std::runtime_error("MappedFile::MappedFile: could not get the size of the file: " + filename);
+        }
+        mapped_size = (size_t)file_stat.st_size;
+
+        if(mapped_size > 0){
+            void* mapping = mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+            if(mapping == MAP_FAILED){
+                close(file_descriptor);
+                throw std::runtime_error("MappedFile::MappedFile: could not map the file: " + filename);
+            }
+            mapped_data = (const char*)mapping;
+        }
+#endif
+    }
+
+    MappedFile::~MappedFile(){
+#ifdef _WIN32
+        if(mapped_data != nullptr)
+            UnmapViewOfFile(mapped_data);
+        if(mapping_handle != NULL)
+            CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+#else
+        if(mapped_data != nullptr)
+            munmap((void*)mapped_data, mapped_size);
+        close(file_descriptor);
+#endif
+    }
+}
@@ -7,6 +7,15 @@
 #pragma once
 #include <pfaces-sdk.h>
 
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <functional>
+
 namespace pFacesOmegaKernels {
 
     // special types
@@ -55,6 +64,16 @@ namespace pFacesOmegaKernels {
 			const std::vector<concrete_t>& x_lb,
 			const std::vector<symbolic_t>& x_widths);
 
+		// a 64-bit FNV-1a hash of a text as 16 hex digits (names the files of the caches)
+		static
+		std::string HashKey(const std::string& text);
+
+		// adds a file to a cache: write(tmp_file) writes it to a temporary file that is then renamed, so
+		// other runs sharing the cache never see half-written files. false if the file is not in the
+		// cache afterwards (a failed write is fine if another run added the same file meanwhile)
+		static
+		bool WriteCacheFile(const std::string& cache_file, const std::function<void(const std::string&)>& write);
+
         // print a vector of anything
         template<class T>
         static void print_vector(const std::vector<T>& vec, std::ostream& ost = std::cout);
@@ -63,4 +82,131 @@ namespace pFacesOmegaKernels {
         template<class T>
         static void scan_vector(std::vector<T>& vec, std::istream& ist);
 	};
+
+    // a read-only memory mapping of a whole file (the pages are loaded by the OS when touched)
+    class MappedFile {
+        const char* mapped_data;
+        size_t mapped_size;
+#ifdef _WIN32
+        void* file_handle;
+        void* mapping_handle;
+#else
+        int file_descriptor;
+#endif
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+    public:
+        MappedFile(const std::string& filename);
+        ~MappedFile();
+
+        const char* data() const { return mapped_data; }
+        size_t size() const { return mapped_size; }
+    };
+
+    // a parallel-for with work stealing: the range [0,n) is cut into chunks of size grain
+    // that are dealt to the queues of the workers (their local frontiers). a worker takes
+    // chunks from the front of its own queue and, once it runs dry, steals chunks from the 
+    // back of the queues of the other workers. the first exception thrown by a worker is
+    // re-thrown after all workers are joined
+    template <typename F>
+    void work_stealing_for(const size_t n, size_t n_threads, const size_t grain, F&& func) {
+        const size_t n_chunks = (n + grain - 1) / grain;
+        n_threads = std::min(n_threads, n_chunks);
+        if (n_threads <= 1) {
+            if (n > 0)
+                func(0, n);
+            return;
+        }
+
+        struct WorkerQueue {
+            std::mutex lock;
+            std::deque<size_t> chunks;
+        };
+        std::vector<WorkerQueue> queues(n_threads);
+        for (size_t c = 0; c < n_chunks; c++)
+            queues[(c * n_threads) / n_chunks].chunks.push_back(c);
+
+        std::mutex error_lock;
+        std::exception_ptr error;
+        std::atomic<bool> failed(false);
+
+        auto worker = [&](const size_t w) {
+            while (!failed) {
+                size_t chunk = 0;
+                bool found = false;
+                for (size_t i = 0; i < n_threads && !found; i++) {
+                    WorkerQueue& queue = queues[(w + i) % n_threads];
+                    std::lock_guard<std::mutex> guard(queue.lock);
+                    if (!queue.chunks.empty()) {
+                        if (i == 0) {
+                            chunk = queue.chunks.front();
+                            queue.chunks.pop_front();
+                        }
+                        else {
+                            chunk = queue.chunks.back();
+                            queue.chunks.pop_back();
+                        }
+                        found = true;
+                    }
+                }
+                if (!found)
+                    return;
+
+                try {
+                    const size_t begin = chunk * grain;
+                    func(begin, std::min(n, begin + grain));
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> guard(error_lock);
+                    if (!error)
+                        error = std::current_exception();
+                    failed = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < n_threads; w++)
+            threads.emplace_back(worker, w);
+        worker(0);
+        for (auto& thread : threads)
+            thread.join();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // an in-place inclusive prefix-sum of values[0,n) by many threads: each thread scans a
+    // block, the sums of the blocks are scanned, and each thread adds the sum of the blocks
+    // before its block
+    template <typename T>
+    void parallel_prefix_sum(T* values, const size_t n, const size_t n_threads) {
+        const size_t n_blocks = std::max<size_t>(1, n_threads);
+        const size_t block_size = (n + n_blocks - 1) / n_blocks;
+        auto block_begin = [&](const size_t block) { return std::min(n, block * block_size); };
+
+        std::vector<T> blocks_sums(n_blocks + 1, 0);
+        work_stealing_for(n_blocks, n_threads, 1, [&](size_t start, size_t end) {
+            for (size_t block = start; block < end; block++) {
+                const size_t begin = block_begin(block);
+                const size_t last = block_begin(block + 1);
+                for (size_t i = begin + 1; i < last; i++)
+                    values[i] += values[i - 1];
+                blocks_sums[block + 1] = (begin < last ? values[last - 1] : 0);
+            }
+        });
+
+        for (size_t block = 0; block < n_blocks; block++)
+            blocks_sums[block + 1] += blocks_sums[block];
+
+        work_stealing_for(n_blocks, n_threads, 1, [&](size_t start, size_t end) {
+            for (size_t block = start; block < end; block++) {
+                const size_t last = block_begin(block + 1);
+                for (size_t i = block_begin(block); i < last; i++)
+                    values[i] += blocks_sums[block];
+            }
+        });
+    }
 }
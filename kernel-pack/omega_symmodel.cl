@@ -11,25 +11,170 @@
 // numerically solved
 #define STEP_TIME (@@STEP_TIME@@)
 
+// the posts are quantized here and stored compactly (1) or stored as
+// concrete reach boxes to be quantized by the host (0)
+#define COMPACT_POSTS (@@COMPACT_POSTS@@)
+
 // prototype of the post function from the included code file
 void model_post(concrete_t* post_x_lb, concrete_t* post_x_ub, const concrete_t* x, const concrete_t* u);
 
 // include the dynamics source file
 #include @pfaces-configValueString:"system.dynamics.code_file"
 
+// quantize the reach box [post_x_lb, post_x_ub] to the post symbols [sym_lb, sym_ub]
+// in concrete_t (the host quantizes the concrete reach boxes with the same expression in
+// get_sym_posts, but a single-precision division of the device may round differently than
+// the host one). returns false if the reach box leaves the state space
+bool quantize_posts(symbolic_t* sym_lb, symbolic_t* sym_ub, const concrete_t* post_x_lb, const concrete_t* post_x_ub);
+bool quantize_posts(symbolic_t* sym_lb, symbolic_t* sym_ub, const concrete_t* post_x_lb, const concrete_t* post_x_ub){
+
+	__private concrete_t eta[ssDim] = {ssQnt};
+	__private concrete_t lb[ssDim]  = {ssLb};
+	__private concrete_t ub[ssDim]  = {ssUb};
+
+	for (unsigned int i = 0; i<ssDim; i++) {
+		if(post_x_lb[i] < lb[i] || post_x_ub[i] > ub[i])
+			return false;
+
+		sym_lb[i] = (symbolic_t)((post_x_lb[i] - lb[i] + eta[i]/2)/eta[i]);
+		sym_ub[i] = (symbolic_t)((post_x_ub[i] - lb[i] + eta[i]/2)/eta[i]);
+		if(sym_ub[i] > (symbolic_t)floor((ub[i]-lb[i])/eta[i]))
+			return false;
+	}
+	return true;
+}
+
+#if COMPACT_POSTS
+// the flags of the compact posts
+#define POSTS_OUT_OF_DOMAIN 1
+
+// the extents of the compact posts: the smallest unsigned type that holds the
+// widths of the states (uchar, ushort or uint)
+typedef @@COMPACT_EXTENT_T@@ compact_extent_t;
+
+// a memory bag for post-state information per (x,y): the flat index of the
+// lower-left post symbol and the number of extra post symbols per dimension
+typedef struct __attribute__((packed)) xu_posts {
+	uint  sym_dest_states_lb_flat;
+	compact_extent_t sym_dest_states_extents[ssDim];
+	uchar flags;
+} xu_posts_t;
+
+// store the post symbols of the reach box [post_x_lb, post_x_ub] compactly
+void compact_posts(__global xu_posts_t* xu_posts, const concrete_t* post_x_lb, const concrete_t* post_x_ub);
+void compact_posts(__global xu_posts_t* xu_posts, const concrete_t* post_x_lb, const concrete_t* post_x_ub){
+
+	__private concrete_t eta[ssDim] = {ssQnt};
+	__private concrete_t lb[ssDim]  = {ssLb};
+	__private concrete_t ub[ssDim]  = {ssUb};
+	__private symbolic_t sym_lb[ssDim];
+	__private symbolic_t sym_ub[ssDim];
+	__private uint lb_flat = 0;
+	__private uint volume = 1;
+
+	if(!quantize_posts(sym_lb, sym_ub, post_x_lb, post_x_ub)){
+		xu_posts->sym_dest_states_lb_flat = 0;
+		xu_posts->flags = POSTS_OUT_OF_DOMAIN;
+		return;
+	}
+
+	for (unsigned int i = 0; i<ssDim; i++) {
+		xu_posts->sym_dest_states_extents[i] = (compact_extent_t)(sym_ub[i] - sym_lb[i]);
+		lb_flat += (uint)sym_lb[i]*volume;
+		volume *= (uint)(floor((ub[i]-lb[i])/eta[i])+1);
+	}
+
+	xu_posts->sym_dest_states_lb_flat = lb_flat;
+	xu_posts->flags = 0;
+}
+#else
 // a memory bag for post-state information per (x,y)
 typedef struct __attribute__((packed)) xu_posts {
 	concrete_t  cnc_dest_states_lb[ssDim];
 	concrete_t  cnc_dest_states_ub[ssDim];
 } xu_posts_t;
+#endif
+
+// the marks of the state symbols in the reach set (see reach_symmodel)
+#define REACH_UNREACHED 0
+#define REACH_REACHED 1
+
+
+// K E R N E L   F U N C T I O N
+// over: symbolic xu space
+// info: this kernel function runs one wave of the forward reachability from the
+//       initial states under any control: the (x,u) of a reached x that is not
+//       yet expanded (a bit per xu in reach_expanded) marks its post symbols as
+//       reached. marks only go up, so a state reached during a wave is expanded
+//       in the same wave or in the next one
+__kernel void reach_symmodel(__global uchar* reach_states, __global uint* reach_expanded){
+
+	__private concrete_t x[ssDim];
+	__private concrete_t u[isDim];
+	__private concrete_t post_x_lb[ssDim];
+	__private concrete_t post_x_ub[ssDim];
+	__private concrete_t eta[ssDim] = {ssQnt};
+	__private concrete_t lb[ssDim]  = {ssLb};
+	__private concrete_t ub[ssDim]  = {ssUb};
+	__private symbolic_t sym_lb[ssDim];
+	__private symbolic_t sym_ub[ssDim];
+	__private symbolic_t post_sym[ssDim];
+	__private symbolic_t post_flat;
+	__private symbolic_t volume;
+	__private symbolic_t thread_idx_x;
+	__private symbolic_t thread_idx_u;
+	__private symbolic_t flat_thread_idx;
+	__private uint expanded_bit;
+	__private unsigned int i;
+
+	thread_idx_x = UNIVERSAL_INDEX_X;
+	thread_idx_u = UNIVERSAL_INDEX_Y;
+	flat_thread_idx = thread_idx_u + thread_idx_x*UNIVERSAL_WIDTH_Y;
+	expanded_bit = 1u << (flat_thread_idx % 32);
+
+	if(reach_states[thread_idx_x] == REACH_UNREACHED || (reach_expanded[flat_thread_idx/32] & expanded_bit))
+		return;
+
+	get_concrete_x(thread_idx_x, x);
+	get_concrete_u(thread_idx_u, u);
+	model_post(post_x_lb, post_x_ub, x, u);
+
+	// the posts out of the state space lead to the losing sink and are not explored
+	if(quantize_posts(sym_lb, sym_ub, post_x_lb, post_x_ub)){
+		for (i = 0; i<ssDim; i++)
+			post_sym[i] = sym_lb[i];
+
+		while(true){
+			post_flat = 0;
+			volume = 1;
+			for (i = 0; i<ssDim; i++){
+				post_flat += post_sym[i]*volume;
+				volume *= (symbolic_t)(floor((ub[i]-lb[i])/eta[i])+1);
+			}
+			reach_states[post_flat] = REACH_REACHED;
+
+			// the next post symbol in the box
+			for (i = 0; i<ssDim && post_sym[i] == sym_ub[i]; i++)
+				post_sym[i] = sym_lb[i];
+			if(i == ssDim)
+				break;
+			post_sym[i]++;
+		}
+	}
+
+	atomic_or(&reach_expanded[flat_thread_idx/32], expanded_bit);
+}
 
 
 // K E R N E L   F U N C T I O N
 // over: symbolic xu space
 // info: this kernel function computes the posts of symbolic models
 //       the cuntion operates on only on (x,u) and stores the posts
-//       to the corresponding xu-bag in xu_bags
-__kernel void construct_symmodel(__global xu_posts_t* xu_posts_bags){
+//       to the corresponding xu-bag in xu_bags. the XU space may be
+//       launched in tiles of x symbols (the global offset is the first
+//       x of the tile) where xu_bags only holds the bags of the tile. the
+//       x symbols out of the reach set (see reach_symmodel) are skipped
+__kernel void construct_symmodel(__global xu_posts_t* xu_posts_bags, __global const uchar* reach_states){
 
 	__private concrete_t x[ssDim];
 	__private concrete_t u[isDim];
@@ -41,7 +186,10 @@ __kernel void construct_symmodel(__global xu_posts_t* xu_posts_bags){
 
 	thread_idx_x = UNIVERSAL_INDEX_X;
 	thread_idx_u = UNIVERSAL_INDEX_Y;
-	flat_thread_idx = thread_idx_u + thread_idx_x*UNIVERSAL_WIDTH_Y;
+	flat_thread_idx = thread_idx_u + (thread_idx_x - get_global_offset(0))*UNIVERSAL_WIDTH_Y;
+
+	if(reach_states[thread_idx_x] == REACH_UNREACHED)
+		return;
 
 	get_concrete_x(thread_idx_x, x);
 	get_concrete_u(thread_idx_u, u);
@@ -53,8 +201,12 @@ __kernel void construct_symmodel(__global xu_posts_t* xu_posts_bags){
 	}
 	*/
 
+#if COMPACT_POSTS
+	compact_posts(&xu_posts_bags[flat_thread_idx], post_x_lb, post_x_ub);
+#else
 	for (unsigned int i = 0; i<ssDim; i++) {
 		xu_posts_bags[flat_thread_idx].cnc_dest_states_lb[i] = post_x_lb[i];
 		xu_posts_bags[flat_thread_idx].cnc_dest_states_ub[i] = post_x_ub[i];
-	}	
+	}
+#endif
 }
\ No newline at end of file
@@ -2,4 +2,6 @@
 
 cd examples/robot2d
 pfaces -CG -d 1 -k omega@../../kernel-pack -cfg robot.cfg
+pfaces -CG -d 1 -k omega@../../kernel-pack -cfg robot_parallel.cfg
+pfaces -CG -d 1 -k omega@../../kernel-pack -cfg robot_compact.cfg
 cd ..
\ No newline at end of file